@@ -0,0 +1,443 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <array>
+#include <thread>
+#include <future>
+#include <stdexcept>
+
+#include "DecoderFormat.hpp"
+#include "DecoderUtility.hpp"
+#include "RawWordsFraming.hpp"
+#include "TPCData.hpp"
+#include "FADCData.hpp"
+#include "CounterData.hpp"
+#include "StreamRawData.hpp"
+#include "BuiltEventData.hpp"
+#include "BoundedQueue.hpp"
+#include "BatchWriter.hpp"
+
+// Run _func _nRepeat times and return the mean elapsed time in seconds.
+double MeasureSeconds(const std::function<void()> &_func, unsigned int _nRepeat)
+{
+    auto timeBegin = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < _nRepeat; ++i)
+        _func();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeBegin;
+    return elapsed.count() / _nRepeat;
+}
+
+void PrintThroughput(const std::string &_name, double _seconds, double _nBytes)
+{
+    std::cout << std::setw(32) << std::left << _name << " : "
+              << std::setw(10) << std::right << std::fixed << std::setprecision(3) << _nBytes / _seconds / 1.e9 << " GB/s" << std::endl;
+}
+
+// Byte-swap kernels: per-word CorrectRawWord() vs bulk CorrectRawWords()
+void BenchByteSwap(unsigned int _nMegaBytes, unsigned int _nRepeat)
+{
+    const std::size_t nWords = (std::size_t)_nMegaBytes * (1 << 20) / sizeof(MAIKo2Decoder::WordType);
+    const double nBytes = nWords * sizeof(MAIKo2Decoder::WordType);
+
+    std::mt19937 rng(12345);
+    std::vector<MAIKo2Decoder::WordType> raw(nWords);
+    std::generate(raw.begin(), raw.end(), rng);
+    std::vector<MAIKo2Decoder::WordType> wordsScalar(nWords), wordsBulk(nWords);
+
+    std::cout << "[Byte swap] " << _nMegaBytes << " MB x " << _nRepeat << std::endl;
+
+    auto secScalar = MeasureSeconds(
+        [&]()
+        {
+            std::transform(raw.begin(), raw.end(), wordsScalar.begin(),
+                           [](const auto &_val)
+                           { return MAIKo2Decoder::CorrectRawWord(_val); });
+        },
+        _nRepeat);
+    PrintThroughput("CorrectRawWord (per word)", secScalar, nBytes);
+
+    auto secBulk = MeasureSeconds(
+        [&]()
+        { MAIKo2Decoder::CorrectRawWords(raw.data(), wordsBulk.data(), nWords); },
+        _nRepeat);
+    PrintThroughput("CorrectRawWords (" + MAIKo2Decoder::GetCorrectRawWordsKernelName() + ")", secBulk, nBytes);
+
+    if (wordsScalar != wordsBulk)
+        std::cerr << "[Error] : Results of the byte swap kernels differ." << std::endl;
+}
+
+// Event footer search: per-word comparison of corrected words vs vectorized FindRawWord()
+void BenchPatternSearch(unsigned int _nMegaBytes, unsigned int _nRepeat)
+{
+    const std::size_t nWords = (std::size_t)_nMegaBytes * (1 << 20) / sizeof(MAIKo2Decoder::WordType);
+    const double nBytes = nWords * sizeof(MAIKo2Decoder::WordType);
+
+    // No footer in the block: the whole block is searched.
+    std::mt19937 rng(23456);
+    std::vector<MAIKo2Decoder::WordType> raw(nWords);
+    std::generate(raw.begin(), raw.end(),
+                  [&rng]()
+                  {
+                      MAIKo2Decoder::WordType word = rng();
+                      return (word == MAIKo2Decoder::RawEventFooter) ? 0 : word;
+                  });
+
+    std::cout << "[Footer search] " << _nMegaBytes << " MB x " << _nRepeat << std::endl;
+
+    std::size_t posScalar = 0, posVector = 0;
+    auto secScalar = MeasureSeconds(
+        [&]()
+        {
+            posScalar = nWords;
+            for (std::size_t i = 0; i < nWords; ++i)
+            {
+                if (MAIKo2Decoder::CorrectRawWord(raw[i]) == MAIKo2Decoder::EventFooter)
+                {
+                    posScalar = i;
+                    break;
+                }
+            }
+        },
+        _nRepeat);
+    PrintThroughput("Compare per word", secScalar, nBytes);
+
+    auto secVector = MeasureSeconds(
+        [&]()
+        { posVector = MAIKo2Decoder::FindRawWord(raw.data(), 0, nWords, MAIKo2Decoder::RawEventFooter); },
+        _nRepeat);
+    PrintThroughput("FindRawWord", secVector, nBytes);
+
+    if (posScalar != posVector)
+        std::cerr << "[Error] : Results of the footer search differ." << std::endl;
+}
+
+// TPC words of an event with _nClocks clocks. Each strip fires with the probability _occupancy.
+std::vector<MAIKo2Decoder::WordType> MakeTPCWords(unsigned int _nClocks, double _occupancy, std::mt19937 &_rng)
+{
+    std::bernoulli_distribution fire(_occupancy);
+    std::vector<MAIKo2Decoder::WordType> words;
+    for (unsigned int iClock = 0; iClock < _nClocks; ++iClock)
+    {
+        words.push_back(0x80000000 | iClock);
+        for (unsigned int iWord = 0; iWord < 4; ++iWord)
+        {
+            MAIKo2Decoder::WordType word = 0;
+            for (unsigned int iBit = 0; iBit < 32; ++iBit)
+                word |= fire(_rng) ? (0x00000001 << iBit) : 0;
+            words.push_back(word);
+        }
+    }
+    return words;
+}
+
+// Reference : test all bits of the strip words and push_back without reserving (former TPCData)
+std::vector<MAIKo2Decoder::TPCData::Hit> DecodeTPCPerBit(const std::vector<MAIKo2Decoder::WordType> &_words)
+{
+    std::vector<MAIKo2Decoder::TPCData::Hit> hits;
+    for (auto it = _words.begin(); it != _words.end(); it = it + 5)
+    {
+        auto clock = *it & 0x0000ffff;
+        for (unsigned int iWord = 0; iWord < 4; ++iWord)
+        {
+            auto word = *(it + 1 + iWord);
+            for (unsigned int iBit = 0; iBit < 32; ++iBit)
+            {
+                if (word & (0x00000001 << iBit))
+                    hits.push_back(MAIKo2Decoder::TPCData::Hit(iBit + (3 - iWord) * 32, clock));
+            }
+        }
+    }
+    return hits;
+}
+
+// TPC hit extraction in hits/s and clocks/s
+void BenchTPCDecode(unsigned int _nRepeat)
+{
+    const unsigned int nClocks = 1024;
+    std::mt19937 rng(34567);
+    std::vector<std::pair<std::string, double>> cases{{"typical (2% occupancy)", 0.02},
+                                                      {"dense (30% occupancy)", 0.3},
+                                                      {"saturated (100% occupancy)", 1.0}};
+
+    std::cout << "[TPC decode] " << nClocks << " clocks x " << _nRepeat * 10 << std::endl;
+    for (const auto &item : cases)
+    {
+        auto words = MakeTPCWords(nClocks, item.second, rng);
+        std::size_t nHits = MAIKo2Decoder::TPCData(words).GetNumberOfHits();
+
+        std::size_t nHitsPerBit = 0;
+        auto secPerBit = MeasureSeconds(
+            [&]()
+            { nHitsPerBit = DecodeTPCPerBit(words).size(); },
+            _nRepeat * 10);
+        std::size_t nHitsDecoded = 0;
+        auto secDecode = MeasureSeconds(
+            [&]()
+            { nHitsDecoded = MAIKo2Decoder::TPCData(words).GetNumberOfHits(); },
+            _nRepeat * 10);
+
+        // Memory of the bitmap vs expanded hits
+        MAIKo2Decoder::TPCData tpc(words);
+        const std::size_t nBytesBitmap = tpc.GetOccupancy().size() * sizeof(MAIKo2Decoder::TPCData::ClockOccupancy);
+        const std::size_t nBytesHits = nHits * sizeof(MAIKo2Decoder::TPCData::Hit);
+        std::size_t nHitsIterated = 0;
+        auto secIterate = MeasureSeconds(
+            [&]()
+            {
+                nHitsIterated = 0;
+                for (auto hit : tpc.GetHitRange())
+                    nHitsIterated += (hit.strip < MAIKo2Decoder::TPCData::NumberOfStrips);
+            },
+            _nRepeat * 10);
+        auto secExpand = MeasureSeconds(
+            [&]()
+            { nHitsIterated = std::min(nHitsIterated, tpc.GetHits().size()); },
+            _nRepeat * 10);
+
+        // Hits of the boards mapped to the plane : inlined policy vs std::function
+        MAIKo2Decoder::BuiltEventData eventInlined;
+        MAIKo2Decoder::MappedBuiltEventData eventMapped(MAIKo2Decoder::FunctionMapping(
+            [](uint32_t, uint32_t _board_id, MAIKo2Decoder::TPCData::Hit _hit) -> MAIKo2Decoder::TPCData::Hit
+            { return {_hit.strip + _board_id * MAIKo2Decoder::TPCData::NumberOfStrips, _hit.clock}; },
+            [](uint32_t, uint32_t _board_id, uint32_t _ch) -> uint32_t
+            { return _ch + _board_id * MAIKo2Decoder::FADCData::NumberOfChannels; }));
+        for (uint32_t iBoard = 0; iBoard < eventInlined.GetNumberOfBoards(); ++iBoard)
+        {
+            MAIKo2Decoder::FragmentedEventData frg;
+            frg.plane_id = 0;
+            frg.board_id = iBoard;
+            frg.tpc = tpc;
+            eventInlined.AddFragment(frg);
+            eventMapped.AddFragment(std::move(frg));
+        }
+        const std::size_t nHitsPlane = nHits * eventInlined.GetNumberOfBoards();
+        std::size_t nHitsInlined = 0;
+        auto secInlined = MeasureSeconds(
+            [&]()
+            { nHitsInlined = eventInlined.GetHits(0).size(); },
+            _nRepeat * 10);
+        std::size_t nHitsMapped = 0;
+        auto secMapped = MeasureSeconds(
+            [&]()
+            { nHitsMapped = eventMapped.GetHits(0).size(); },
+            _nRepeat * 10);
+
+        std::cout << "  " << item.first << " : " << nHits << " hits / event, "
+                  << nBytesBitmap << " bytes (bitmap) vs " << nBytesHits << " bytes (hits)" << std::endl;
+        std::cout << "    " << std::setw(28) << std::left << "per bit (former)" << " : "
+                  << std::scientific << std::setprecision(3) << nHits / secPerBit << " hits/s, "
+                  << nClocks / secPerBit << " clocks/s" << std::endl;
+        std::cout << "    " << std::setw(28) << std::left << "TPCData" << " : "
+                  << std::scientific << std::setprecision(3) << nHits / secDecode << " hits/s, "
+                  << nClocks / secDecode << " clocks/s" << std::endl;
+        std::cout << "    " << std::setw(28) << std::left << "HitIterator" << " : "
+                  << std::scientific << std::setprecision(3) << nHits / secIterate << " hits/s" << std::endl;
+        std::cout << "    " << std::setw(28) << std::left << "GetHits" << " : "
+                  << std::scientific << std::setprecision(3) << nHits / secExpand << " hits/s" << std::endl;
+        std::cout << "    " << std::setw(28) << std::left << "GetHits of plane (inlined)" << " : "
+                  << std::scientific << std::setprecision(3) << nHitsPlane / secInlined << " hits/s" << std::endl;
+        std::cout << "    " << std::setw(28) << std::left << "GetHits of plane (function)" << " : "
+                  << std::scientific << std::setprecision(3) << nHitsPlane / secMapped << " hits/s" << std::endl;
+        std::cout << std::defaultfloat;
+
+        if (nHitsPerBit != nHits || nHitsDecoded != nHits || nHitsIterated != nHits ||
+            nHitsInlined != nHitsPlane || nHitsMapped != nHitsPlane)
+            std::cerr << "[Error] : Numbers of TPC hits differ." << std::endl;
+    }
+}
+
+// Reference : check and push_back sample by sample without reserving (former FADCData)
+std::array<std::vector<MAIKo2Decoder::FADCData::ShortWordType>, 4> DecodeFADCPerSample(const std::vector<MAIKo2Decoder::WordType> &_words)
+{
+    std::array<std::vector<MAIKo2Decoder::FADCData::ShortWordType>, 4> signals;
+    for (auto it = _words.begin(); it != _words.end(); it = it + 2)
+    {
+        std::array<MAIKo2Decoder::FADCData::ShortWordType, 4> sWords{
+            (MAIKo2Decoder::FADCData::ShortWordType)((*it & 0xffff0000) >> 16),
+            (MAIKo2Decoder::FADCData::ShortWordType)(*it & 0x0000ffff),
+            (MAIKo2Decoder::FADCData::ShortWordType)((*(it + 1) & 0xffff0000) >> 16),
+            (MAIKo2Decoder::FADCData::ShortWordType)(*(it + 1) & 0x0000ffff)};
+        bool good = true;
+        for (unsigned int iCh = 0; iCh < 4; ++iCh)
+            good = good && (sWords[iCh] & 0xc000) == 0x4000 && ((sWords[iCh] & 0x3000) >> 12) == iCh;
+        if (good)
+        {
+            for (unsigned int iCh = 0; iCh < 4; ++iCh)
+                signals[iCh].push_back(sWords[iCh] & 0x03ff);
+        }
+    }
+    return signals;
+}
+
+// FADC unpacking in samples/s
+void BenchFADCDecode(unsigned int _nRepeat)
+{
+    const unsigned int nClocks = 1024;
+    std::mt19937 rng(45678);
+    std::vector<MAIKo2Decoder::WordType> words;
+    for (unsigned int iClock = 0; iClock < nClocks; ++iClock)
+    {
+        words.push_back(((0x4000 | (rng() & 0x03ff)) << 16) | (0x5000 | (rng() & 0x03ff)));
+        words.push_back(((0x6000 | (rng() & 0x03ff)) << 16) | (0x7000 | (rng() & 0x03ff)));
+    }
+    const double nSamples = nClocks * MAIKo2Decoder::FADCData::NumberOfChannels;
+
+    std::cout << "[FADC decode] " << nClocks << " clocks x " << _nRepeat * 100 << std::endl;
+
+    std::size_t nSamplesPerSample = 0;
+    auto secPerSample = MeasureSeconds(
+        [&]()
+        { nSamplesPerSample = DecodeFADCPerSample(words)[3].size(); },
+        _nRepeat * 100);
+    std::size_t nSamplesDecoded = 0;
+    auto secDecode = MeasureSeconds(
+        [&]()
+        {
+            MAIKo2Decoder::FADCData fadc(words);
+            nSamplesDecoded = fadc.IsGood() ? fadc.GetSignal(3u).size() : 0;
+        },
+        _nRepeat * 100);
+
+    std::cout << "    " << std::setw(28) << std::left << "per sample (former)" << " : "
+              << std::scientific << std::setprecision(3) << nSamples / secPerSample << " samples/s" << std::endl;
+    std::cout << "    " << std::setw(28) << std::left << "FADCData" << " : "
+              << std::scientific << std::setprecision(3) << nSamples / secDecode << " samples/s" << std::endl;
+    std::cout << std::defaultfloat;
+
+    if (nSamplesPerSample != nClocks || nSamplesDecoded != nClocks)
+        std::cerr << "[Error] : Numbers of FADC samples differ." << std::endl;
+}
+
+// Event framing of a raw-data file: StreamRawData() with each engine vs StreamRawDataInParallel()
+void BenchStreamRawData(const std::string &_fileName, unsigned int _nRepeat)
+{
+    std::cout << "[Stream raw data] " << _fileName << " x " << _nRepeat << std::endl;
+
+    auto bench = [&](const std::string &_name, const std::function<MAIKo2Decoder::StreamRawDataResult()> &_stream)
+    {
+        MAIKo2Decoder::StreamRawDataResult result;
+        auto sec = MeasureSeconds([&]()
+                                  { result = _stream(); },
+                                  _nRepeat);
+        PrintThroughput(_name + " (" + std::to_string(result.number_of_events_processed) + " events)",
+                        sec, result.number_of_bytes_processed);
+    };
+
+    MAIKo2Decoder::StreamRawDataInput inp;
+    inp.fileName = _fileName;
+    inp.engine = MAIKo2Decoder::StreamRawDataEngine::IFStream;
+    bench("StreamRawData (ifstream)", [&]()
+          { return MAIKo2Decoder::StreamRawData(inp, [](const MAIKo2Decoder::RawEventData &)
+                                                { return true; }); });
+    inp.engine = MAIKo2Decoder::StreamRawDataEngine::MemoryMap;
+    bench("StreamRawData (mmap)", [&]()
+          { return MAIKo2Decoder::StreamRawData(inp, [](const MAIKo2Decoder::RawEventData &)
+                                                { return true; }); });
+
+    const unsigned int nChunks = std::max(1u, std::thread::hardware_concurrency());
+    bench("StreamRawDataInParallel (" + std::to_string(nChunks) + ")", [&]()
+          { return MAIKo2Decoder::StreamRawDataInParallel(inp, nChunks, [](unsigned int, const MAIKo2Decoder::RawEventData &)
+                                                          { return true; }); });
+
+    // Seek events spread over the file by the trigger counter
+    std::vector<uint32_t> triggerCounters;
+    MAIKo2Decoder::StreamRawData(inp, [&triggerCounters](const MAIKo2Decoder::RawEventData &_evt)
+                                 {
+                                     triggerCounters.push_back(MAIKo2Decoder::CounterData(_evt.words.GetCounterWords()).GetTriggerCounter());
+                                     return true; });
+    if (triggerCounters.empty())
+        return;
+    const std::size_t nSeeks = std::min<std::size_t>(triggerCounters.size(), 1000);
+    std::size_t nFound = 0;
+    auto secSeek = MeasureSeconds([&]()
+                                  {
+                                      nFound = 0;
+                                      for (std::size_t i = 0; i < nSeeks; ++i)
+                                          nFound += MAIKo2Decoder::SeekTriggerCounter(_fileName, triggerCounters[i * triggerCounters.size() / nSeeks]).goodFlag; },
+                                  _nRepeat);
+    std::cout << std::setw(32) << std::left << "SeekTriggerCounter (" + std::to_string(nFound) + "/" + std::to_string(nSeeks) + " found)" << " : "
+              << std::setw(10) << std::right << std::fixed << std::setprecision(1) << secSeek / nSeeks * 1e6 << " us/seek" << std::endl;
+    std::cout << std::defaultfloat;
+}
+
+// Batches from producers waiting on a small BoundedQueue, written by WriteBatches() : a writer failing on every batch
+// must still drain the queue, so that the producers end and all the batches are counted as failed.
+void BenchBatchWriter(unsigned int _nRepeat)
+{
+    std::cout << "[Batch writer]" << std::endl;
+    const unsigned int nProducers = 4;
+    const unsigned int nBatchesPerProducer = 10000;
+    const std::size_t nRecordsPerBatch = 16;
+    const uint64_t nBatches = (uint64_t)nProducers * nBatchesPerProducer;
+
+    for (bool failing : {false, true})
+    {
+        MAIKo2Decoder::BatchWriteStatistics statistics;
+        auto sec = MeasureSeconds([&]()
+                                  {
+                                      MAIKo2Decoder::BoundedQueue<std::vector<uint64_t>> queue(4);
+                                      auto writer = std::async(std::launch::async, [&]()
+                                                               { return MAIKo2Decoder::WriteBatches(
+                                                                     queue,
+                                                                     [&](std::vector<uint64_t> &_batch) -> std::size_t
+                                                                     {
+                                                                         if (failing)
+                                                                             throw std::runtime_error("failed");
+                                                                         return _batch.size();
+                                                                     },
+                                                                     [](const std::vector<uint64_t> &, std::exception_ptr) {}); });
+                                      std::vector<std::thread> producers;
+                                      for (unsigned int iProducer = 0; iProducer < nProducers; ++iProducer)
+                                          producers.emplace_back([&]()
+                                                                 {
+                                                                     for (unsigned int iBatch = 0; iBatch < nBatchesPerProducer; ++iBatch)
+                                                                         queue.Push(std::vector<uint64_t>(nRecordsPerBatch, iBatch)); });
+                                      for (auto &producer : producers)
+                                          producer.join();
+                                      queue.Close();
+                                      statistics = writer.get(); },
+                                  _nRepeat);
+
+        std::cout << "    " << std::setw(28) << std::left << (failing ? "failing on every batch" : "writing every batch") << " : "
+                  << std::scientific << std::setprecision(3) << nBatches / sec << " batches/s" << std::endl;
+        std::cout << std::defaultfloat;
+
+        const uint64_t nFailedExpected = failing ? nBatches : 0;
+        const uint64_t nRecordsExpected = failing ? 0 : nBatches * nRecordsPerBatch;
+        if (statistics.number_of_batches != nBatches || statistics.number_of_failed_batches != nFailedExpected ||
+            statistics.number_of_records != nRecordsExpected)
+            std::cerr << "[Error] : " << statistics.number_of_batches << " batches written with "
+                      << statistics.number_of_failed_batches << " failed, while " << nBatches << " batches pushed." << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int nMegaBytes = 64;
+    unsigned int nRepeat = 10;
+    if (argc > 1)
+        nMegaBytes = atoi(argv[1]);
+    if (argc > 2)
+        nRepeat = atoi(argv[2]);
+
+    if (nMegaBytes == 0 || nRepeat == 0)
+    {
+        std::cerr << "[Usage] : " << argv[0] << " [size_in_MB] [n_repeat] [raw_data_file]" << std::endl;
+        return 1;
+    }
+
+    BenchByteSwap(nMegaBytes, nRepeat);
+    BenchPatternSearch(nMegaBytes, nRepeat);
+    BenchTPCDecode(nRepeat);
+    BenchFADCDecode(nRepeat);
+    BenchBatchWriter(nRepeat);
+    if (argc > 3)
+        BenchStreamRawData(argv[3], nRepeat);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+
+#include "DecoderUtility.hpp"
+#include "EventBuilder.hpp"
+#include "BuiltEventFile.hpp"
+
+// Build the events of a run from the raw data files and write them into a built-event file (no DB access)
+int main(int argc, char *argv[])
+{
+    if (argc < 4)
+    {
+        std::cerr << "[Usage] : " << argv[0] << " [run_id] [data_directory_path] [output_file] [raw_data_file_format]" << std::endl;
+        return 1;
+    }
+
+    uint32_t run_id = atoi(argv[1]);
+    const std::string dataDirectoryPath = argv[2];
+    const std::string outputFilePath = argv[3];
+    const std::string rawDataFileFormat = (argc > 4) ? argv[4] : "uTPC_$[run_id]_$[plane]$[board_id]_$[file_number].raw";
+
+    const std::map<unsigned int, std::string> planeList = {{0, "anode"},
+                                                           {1, "cathode"}};
+    const unsigned int nPlane = 2;
+    const unsigned int nBoard = 6;
+
+    std::vector<MAIKo2Decoder::BoardEventScanner> scanners;
+    for (unsigned int iPlane = 0; iPlane < nPlane; ++iPlane)
+    {
+        for (unsigned int iBoard = 0; iBoard < nBoard; ++iBoard)
+        {
+            auto filePaths = MAIKo2Decoder::ListRawDataFiles(
+                [&](uint32_t _fileNumber)
+                {
+                    return dataDirectoryPath + "/" + MAIKo2Decoder::GenerateFileName(rawDataFileFormat,
+                                                                                     run_id, 4,
+                                                                                     iPlane, planeList,
+                                                                                     iBoard, 1,
+                                                                                     _fileNumber, 5);
+                });
+            if (filePaths.empty())
+                std::cerr << "[Warning] : No raw data file of plane " << iPlane << ", board " << iBoard << " is found." << std::endl;
+            scanners.emplace_back(iPlane, iBoard, std::move(filePaths));
+        }
+    }
+
+    MAIKo2Decoder::BuiltEventFileWriter writer(outputFilePath, run_id);
+    if (!writer.IsGood())
+    {
+        std::cerr << "[Error] : File " << outputFilePath << " can not be written." << std::endl;
+        return 1;
+    }
+
+    auto timeBegin = std::chrono::steady_clock::now();
+    MAIKo2Decoder::EventBuilder builder(run_id, std::move(scanners), false);
+    MAIKo2Decoder::StreamedBuiltEvent event;
+    while (builder.Next(event))
+    {
+        if (!writer.Write(event))
+        {
+            std::cerr << "[Error] : Failed to write the event " << event.trigger_counter << " into " << outputFilePath << std::endl;
+            return 1;
+        }
+    }
+    if (!writer.Close())
+    {
+        std::cerr << "[Error] : Failed to close " << outputFilePath << std::endl;
+        return 1;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeBegin;
+
+    uint64_t nBytesRead = 0;
+    for (auto &scanner : builder.GetScanners())
+    {
+        for (auto &result : scanner.GetFileResults())
+        {
+            nBytesRead += result.number_of_bytes_processed;
+            if (!result.goodFlag)
+            {
+                std::cerr << "[Warning] : Raw data file " << result.input.fileName << " ended with an error after "
+                          << result.number_of_events_processed << " events "
+                          << "(fileNotFound " << result.fileNotFound << ", noEventFound " << result.noEventFound << ", "
+                          << "noEventFooter " << result.noEventFooter << ", eventFormatError " << result.eventFormatError << ")." << std::endl;
+            }
+        }
+    }
+
+    std::cout << "Built : " << builder.GetNumberOfEventsBuilt() << " events "
+              << "(" << builder.GetNumberOfIncompleteEvents() << " with missing or duplicate fragments) "
+              << "into " << outputFilePath << std::endl;
+    std::cout << "Read : " << std::fixed << std::setprecision(1) << nBytesRead / 1.e6 << " MB in " << elapsed.count() << " s "
+              << "(" << nBytesRead / 1.e6 / elapsed.count() << " MB/s), "
+              << "written : " << writer.GetNumberOfBytesWritten() / 1.e6 << " MB" << std::endl;
+    return 0;
+}
\ No newline at end of file
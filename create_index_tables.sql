@@ -25,6 +25,9 @@ CREATE TABLE IF NOT EXISTS test.raw_files(
     board_id integer NOT NULL,
     file_number integer NOT NULL,
     file_path varchar(100) NOT NULL,
+    file_size bigint,
+    file_mtime bigint,
+    file_fingerprint bigint,
     PRIMARY KEY (run_id, plane_id, board_id, file_number)
 );
 
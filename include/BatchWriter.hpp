@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <exception>
+#include "BoundedQueue.hpp"
+
+namespace MAIKo2Decoder
+{
+
+    // Number of batches and records written by WriteBatches() and the time spent
+    struct BatchWriteStatistics
+    {
+        uint64_t number_of_batches = 0;
+        uint64_t number_of_records = 0;
+        uint64_t number_of_failed_batches = 0;
+        double elapsed_seconds = 0.;
+    };
+
+    // Pop batches from _queue and write each of them with _write(batch), which returns the number of records written,
+    // until the queue is closed and no batch is left.
+    // A batch for which _write throws is counted as failed and given to _onError(batch, exception), which must not throw.
+    // Batches are popped to the end even if every one fails, so that the producers waiting in Push() are never stuck.
+    template <typename Batch, typename Write, typename OnError>
+    BatchWriteStatistics WriteBatches(BoundedQueue<Batch> &_queue, Write &&_write, OnError &&_onError)
+    {
+        BatchWriteStatistics statistics;
+        Batch batch;
+        while (_queue.Pop(batch))
+        {
+            auto timeBegin = std::chrono::steady_clock::now();
+            ++statistics.number_of_batches;
+            try
+            {
+                statistics.number_of_records += _write(batch);
+            }
+            catch (...)
+            {
+                ++statistics.number_of_failed_batches;
+                _onError(static_cast<const Batch &>(batch), std::current_exception());
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeBegin;
+            statistics.elapsed_seconds += elapsed.count();
+        }
+        return statistics;
+    }
+}
\ No newline at end of file
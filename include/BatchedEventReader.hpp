@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BuiltEventData.hpp"
+
+namespace MAIKo2Decoder
+{
+    // Location of an event fragment in a raw data file (a row of the raw events table joined with the raw files table)
+    struct FragmentLocation
+    {
+        uint32_t run_id;
+        uint32_t plane_id;
+        uint32_t board_id;
+        std::string file_path;
+        uint64_t event_data_address;
+        uint32_t event_data_length;
+        uint32_t event_fadc_words_offset; // With event_tpc_words_offset, 0 if unknown (the words are validated instead)
+        uint32_t event_tpc_words_offset;
+        uint32_t event_trigger_counter;
+    };
+
+    // Fragments of an event read by BatchedEventReader
+    struct FetchedEvent
+    {
+        uint32_t trigger_counter = 0;
+        std::vector<StoredFragment> fragments; // in the order of (plane_id, board_id)
+        bool good = true;                      // False if any fragment could not be read or is in the wrong format
+    };
+
+    struct BatchedReadStatistics
+    {
+        uint64_t number_of_fragments = 0;
+        uint64_t number_of_failed_fragments = 0;
+        uint64_t number_of_files = 0;
+        uint64_t number_of_reads = 0; // pread() of merged ranges
+        uint64_t number_of_bytes_read = 0;
+    };
+
+    // Reader of the fragments of many events at once.
+    // Fragments are grouped by file and sorted by the address, and the reads of nearby fragments are merged,
+    // so that scrolling through consecutive events costs a few sequential reads per file instead of a seek per fragment.
+    class BatchedEventReader
+    {
+    public:
+        // Fragments are read together if the gap between them is up to _maxGapBytes, up to _maxReadBytes at once.
+        BatchedEventReader(uint64_t _maxGapBytes = DefaultMaxGapBytes, uint64_t _maxReadBytes = DefaultMaxReadBytes)
+            : fMaxGapBytes(_maxGapBytes), fMaxReadBytes(_maxReadBytes), fStatistics(){};
+
+        // Read the fragments at _locations. Events are in the order of the trigger counter.
+        std::vector<FetchedEvent> Read(const std::vector<FragmentLocation> &_locations);
+
+        // Statistics of the last Read()
+        const BatchedReadStatistics &GetStatistics() const { return fStatistics; }
+
+        // Decode (concurrently on _pool if given) and build the fragments of _fetched into _event (of any mapping policy).
+        // Return false if any fragment is rejected.
+        static bool BuildEvent(uint32_t _run_id, const FetchedEvent &_fetched, BuiltEventStore &_event,
+                               WorkStealingPool *_pool = nullptr);
+
+        inline static const uint64_t DefaultMaxGapBytes = 1 << 16;  // 64 KiB
+        inline static const uint64_t DefaultMaxReadBytes = 1 << 26; // 64 MiB
+
+    private:
+        uint64_t fMaxGapBytes;
+        uint64_t fMaxReadBytes;
+        BatchedReadStatistics fStatistics;
+    };
+}
\ No newline at end of file
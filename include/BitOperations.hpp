@@ -0,0 +1,31 @@
+#pragma once
+#include "DecoderFormat.hpp"
+
+namespace MAIKo2Decoder
+{
+    // Number of set bits in _word
+    inline unsigned int CountSetBits(WordType _word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcount(_word);
+#else
+        unsigned int count = 0;
+        for (; _word != 0; _word &= _word - 1)
+            ++count;
+        return count;
+#endif
+    }
+
+    // Position of the least significant set bit in _word. _word must not be 0.
+    inline unsigned int CountTrailingZeros(WordType _word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctz(_word);
+#else
+        unsigned int count = 0;
+        for (; (_word & 0x00000001) == 0; _word >>= 1)
+            ++count;
+        return count;
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace MAIKo2Decoder
+{
+
+    // Thread-safe FIFO queue holding at most a fixed number of items.
+    // Push() blocks while the queue is full, so that producers faster than consumers are held back (backpressure).
+    template <typename T>
+    class BoundedQueue
+    {
+    public:
+        explicit BoundedQueue(std::size_t _capacity) : fCapacity(_capacity > 0 ? _capacity : 1), fClosed(false) {}
+
+        BoundedQueue(const BoundedQueue &) = delete;
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        // Wait for a room and add _item. Return false (and drop _item) if the queue is closed.
+        bool Push(T _item)
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fNotFull.wait(lock, [this]()
+                          { return fItems.size() < fCapacity || fClosed; });
+            if (fClosed)
+                return false;
+            fItems.push_back(std::move(_item));
+            lock.unlock();
+            fNotEmpty.notify_one();
+            return true;
+        }
+
+        // Wait for an item and take it. Return false if the queue is closed and no item is left.
+        bool Pop(T &_item)
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fNotEmpty.wait(lock, [this]()
+                           { return !fItems.empty() || fClosed; });
+            if (fItems.empty())
+                return false;
+            _item = std::move(fItems.front());
+            fItems.pop_front();
+            lock.unlock();
+            fNotFull.notify_one();
+            return true;
+        }
+
+        // No more items are pushed. Items left are still popped.
+        void Close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                fClosed = true;
+            }
+            fNotFull.notify_all();
+            fNotEmpty.notify_all();
+        }
+
+        std::size_t GetCapacity() const { return fCapacity; }
+
+    private:
+        const std::size_t fCapacity;
+        bool fClosed;
+        std::deque<T> fItems;
+        std::mutex fMutex;
+        std::condition_variable fNotFull;
+        std::condition_variable fNotEmpty;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+#include "EventWordsBuffer.hpp"
+#include "CounterData.hpp"
+#include "FADCData.hpp"
+#include "TPCData.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace MAIKo2Decoder
+{
+
+    // Data of an event from a board
+    struct FragmentedEventData
+    {
+        uint32_t run_id;
+        uint32_t plane_id;
+        uint32_t board_id;
+        uint32_t event_number;
+        CounterData counter;
+        FADCData fadc;
+        TPCData tpc;
+    };
+
+    // Words of an event from a board (byte-order corrected), e.g. read from a file
+    struct StoredFragment
+    {
+        uint32_t plane_id;
+        uint32_t board_id;
+        EventWordsBuffer words;
+    };
+
+    // Decode the words of an event from a board
+    FragmentedEventData DecodeFragment(uint32_t _run_id, uint32_t _plane_id, uint32_t _board_id, uint32_t _event_number,
+                                       const EventWordsBuffer &_words);
+
+    // Time spent for a fragment of an event
+    struct FragmentTiming
+    {
+        uint32_t plane_id = 0;
+        uint32_t board_id = 0;
+        double read_seconds = 0.;   // Framing and copying the words, if known
+        double decode_seconds = 0.; // CounterData, FADCData and TPCData
+    };
+
+    // Decode _fragments concurrently on _pool (in the calling thread if nullptr), in the order of _fragments.
+    // Each task writes only its own element, so that no lock is taken per fragment.
+    // Must not be called from a task of _pool.
+    std::vector<FragmentedEventData> DecodeFragments(uint32_t _run_id, uint32_t _event_number,
+                                                     const std::vector<StoredFragment> &_fragments,
+                                                     WorkStealingPool *_pool, std::vector<FragmentTiming> &_timings);
+
+    // Mapping policies of the strips and FADC channels of the boards to those of the plane, given to BasicBuiltEventData.
+    // A policy provides
+    //     Hit MapHit(uint32_t _plane_id, uint32_t _board_id, const Hit &_hit) const
+    //     uint32_t MapFADCCh(uint32_t _plane_id, uint32_t _board_id, uint32_t _ch) const
+    // MapHit() is called for every hit, so that it should be inlinable. MapFADCCh() is called only in the constructor.
+
+    // strip + board_id * 128, ch + board_id * 4
+    struct BoardOffsetMapping
+    {
+        static TPCData::Hit MapHit(uint32_t, uint32_t _board_id, const TPCData::Hit &_hit)
+        {
+            return {_hit.strip + _board_id * TPCData::NumberOfStrips, _hit.clock};
+        }
+        static uint32_t MapFADCCh(uint32_t, uint32_t _board_id, uint32_t _ch)
+        {
+            return _ch + _board_id * FADCData::NumberOfChannels;
+        }
+    };
+
+    // Mappers given at run time (an indirect call for every hit)
+    struct FunctionMapping
+    {
+        FunctionMapping(std::function<TPCData::Hit(uint32_t, uint32_t, TPCData::Hit)> _fHitMapper,
+                        std::function<uint32_t(uint32_t, uint32_t, uint32_t)> _fFADCChMapper)
+            : fHitMapper(std::move(_fHitMapper)), fFADCChMapper(std::move(_fFADCChMapper)){};
+
+        TPCData::Hit MapHit(uint32_t _plane_id, uint32_t _board_id, const TPCData::Hit &_hit) const
+        {
+            return fHitMapper(_plane_id, _board_id, _hit);
+        }
+        uint32_t MapFADCCh(uint32_t _plane_id, uint32_t _board_id, uint32_t _ch) const
+        {
+            return fFADCChMapper(_plane_id, _board_id, _ch);
+        }
+
+        // Mapper function for TPC Hit (plane_id, board_id, Hit) -> Hit (mapped)
+        std::function<TPCData::Hit(uint32_t, uint32_t, TPCData::Hit)> fHitMapper;
+
+        // Mapper function for FADC Ch (plane_id, board_id, ch) -> ch (mapped)
+        std::function<uint32_t(uint32_t, uint32_t, uint32_t)> fFADCChMapper;
+    };
+
+    // Fragments of an event from the boards, independent of the mapping of the hits.
+    // Fragments are moved into a [plane][board] array sized by the topology, and mapped FADC channels are
+    // looked up in a [plane][slot] table of (number of boards) x FADCData::NumberOfChannels slots at most, whatever the mapping gives.
+    // The slot is the mapped ch itself if all mapped channels are below that number, as with the default mapping,
+    // or else its rank in the sorted mapped channels of the plane, found by a binary search.
+    // The FADC channel mapping is evaluated once in the constructor, so that it must depend only on its arguments.
+    // Reuse an object with Clear() to build events without allocation.
+    class BuiltEventStore
+    {
+    public:
+        using Hit = TPCData::Hit;
+        using ShortWordType = FADCData::ShortWordType;
+
+        inline static const uint32_t DefaultNumberOfPlanes = 2;
+        inline static const uint32_t DefaultNumberOfBoards = 6;
+
+        struct AddFragmentResult
+        {
+            AddFragmentResult()
+                : good(false), fragment_key_duplication(false), map_duplication(false), out_of_topology(false){};
+            bool good;
+            bool fragment_key_duplication;
+            bool map_duplication;
+            bool out_of_topology; // plane_id or board_id beyond the topology (no room is added for it)
+        };
+
+        AddFragmentResult AddFragment(FragmentedEventData &&_frg);
+        AddFragmentResult AddFragment(const FragmentedEventData &_frg) { return AddFragment(FragmentedEventData(_frg)); }
+
+        // Remove the fragments, keeping the topology and the mapping
+        void Clear();
+
+        std::vector<ShortWordType> GetSignal(uint32_t _plane_id, uint32_t _ch) const;
+        std::vector<uint32_t> GetAvailableFADCCh(uint32_t _plane_id) const;
+
+        uint32_t GetNumberOfPlanes() const { return fNumberOfPlanes; };
+        uint32_t GetNumberOfBoards() const { return fNumberOfBoards; };
+
+        // nullptr if the fragment has not been added
+        const FragmentedEventData *GetFragment(uint32_t _plane_id, uint32_t _board_id) const
+        {
+            if (_plane_id >= fNumberOfPlanes || _board_id >= fNumberOfBoards || !fHasFragment[_plane_id * fNumberOfBoards + _board_id])
+                return nullptr;
+            return &fEventFragments[_plane_id * fNumberOfBoards + _board_id];
+        }
+
+    protected:
+        BuiltEventStore(uint32_t _nPlanes, uint32_t _nBoards,
+                        const std::function<uint32_t(uint32_t, uint32_t, uint32_t)> &_fFADCChMapper);
+
+    private:
+        uint32_t fNumberOfPlanes;
+        uint32_t fNumberOfBoards;
+
+        // Fragment store : [plane_id * fNumberOfBoards + board_id]
+        std::vector<FragmentedEventData> fEventFragments;
+        std::vector<char> fHasFragment;
+
+        // Slot of the mapped ch of [plane_id][board_id][ch], evaluated by the mapper in the constructor
+        std::vector<uint32_t> fMappedFADCCh;
+
+        // Mapped ch of each slot : [plane_id][slot] in ascending order. Empty if the slot is the mapped ch itself.
+        std::vector<std::vector<uint32_t>> fFADCChOfSlot;
+
+        // Inverted table for fetching FADC signal : [plane_id * fNumberOfFADCSlots + slot]
+        // -> board_id * FADCData::NumberOfChannels + ch, or NoFADCCh
+        uint32_t fNumberOfFADCSlots;
+        std::vector<uint32_t> fFADCChTable;
+        inline static const uint32_t NoFADCCh = UINT32_MAX;
+
+        // Slot of mapped _ch of the plane, or fNumberOfFADCSlots if no board is mapped to it
+        uint32_t FindFADCSlot(uint32_t _plane_id, uint32_t _ch) const;
+    };
+
+    // Data of an event built from the fragments of the boards.
+    // Strips and FADC channels of the boards are mapped to those of the plane by MappingPolicy.
+    template <class MappingPolicy>
+    class BasicBuiltEventData : public BuiltEventStore
+    {
+    public:
+        BasicBuiltEventData(uint32_t _nPlanes = DefaultNumberOfPlanes, uint32_t _nBoards = DefaultNumberOfBoards)
+            : BasicBuiltEventData(MappingPolicy(), _nPlanes, _nBoards){};
+
+        explicit BasicBuiltEventData(MappingPolicy _mapping,
+                                     uint32_t _nPlanes = DefaultNumberOfPlanes, uint32_t _nBoards = DefaultNumberOfBoards)
+            : BuiltEventStore(_nPlanes, _nBoards,
+                              [&_mapping](uint32_t _plane_id, uint32_t _board_id, uint32_t _ch)
+                              { return _mapping.MapFADCCh(_plane_id, _board_id, _ch); }),
+              fMapping(std::move(_mapping)){};
+
+        std::vector<Hit> GetHits(uint32_t _plane_id) const
+        {
+            std::vector<Hit> ret;
+            std::size_t nHits = 0;
+            for (uint32_t iBoard = 0; iBoard < GetNumberOfBoards(); ++iBoard)
+            {
+                if (auto frg = GetFragment(_plane_id, iBoard))
+                    nHits += frg->tpc.GetNumberOfHits();
+            }
+            ret.reserve(nHits);
+
+            for (uint32_t iBoard = 0; iBoard < GetNumberOfBoards(); ++iBoard)
+            {
+                auto frg = GetFragment(_plane_id, iBoard);
+                if (frg == nullptr)
+                    continue;
+
+                // Expand the hits of the board, then map them in place in a loop without calls for inlined policies
+                const std::size_t first = ret.size();
+                frg->tpc.AppendHits(ret);
+                Hit *hits = ret.data() + first;
+                const std::size_t nHitsOfBoard = ret.size() - first;
+                for (std::size_t i = 0; i < nHitsOfBoard; ++i)
+                    hits[i] = fMapping.MapHit(_plane_id, iBoard, hits[i]);
+            }
+            return ret;
+        }
+
+        const MappingPolicy &GetMapping() const { return fMapping; };
+
+    private:
+        MappingPolicy fMapping;
+    };
+
+    // Default : strip + board_id * 128, ch + board_id * 4
+    using BuiltEventData = BasicBuiltEventData<BoardOffsetMapping>;
+
+    // Custom mappers given as functions
+    using MappedBuiltEventData = BasicBuiltEventData<FunctionMapping>;
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "EventWordsBuffer.hpp"
+#include "BuiltEventData.hpp"
+#include "EventBuilder.hpp"
+
+namespace MAIKo2Decoder
+{
+    // File of the built events of a run. All fragments of an event are stored contiguously,
+    // so that an event is read with a single pread() instead of a seek per board file.
+    //
+    // Layout (host byte order) :
+    //     BuiltEventFileHeader
+    //     Event records, each of which is
+    //         BuiltEventRecordHeader
+    //         (BuiltEventFragmentHeader + words of the fragment, byte-order corrected) x number_of_fragments
+    //     BuiltEventTableEntry x number_of_events, sorted by trigger_counter (at table_address)
+
+    struct BuiltEventFileHeader
+    {
+        char magic[8];     // "MK2BEVT"
+        uint32_t version;  // Version
+        uint32_t run_id;
+        uint64_t number_of_events;
+        uint64_t table_address;  // in byte
+        uint64_t table_checksum; // HashBytesFNV1a() of the table
+        uint64_t reserved;
+
+        inline static const char Magic[8] = "MK2BEVT";
+        inline static const uint32_t Version = 1;
+    };
+    static_assert(sizeof(BuiltEventFileHeader) == 48, "BuiltEventFileHeader must be packed without padding");
+
+    struct BuiltEventRecordHeader
+    {
+        uint32_t trigger_counter;
+        uint32_t number_of_fragments;
+    };
+    static_assert(sizeof(BuiltEventRecordHeader) == 8, "BuiltEventRecordHeader must be packed without padding");
+
+    struct BuiltEventFragmentHeader
+    {
+        uint32_t plane_id;
+        uint32_t board_id;
+        uint32_t number_of_words;
+        uint32_t event_fadc_words_offset;
+        uint32_t event_tpc_words_offset;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(BuiltEventFragmentHeader) == 24, "BuiltEventFragmentHeader must be packed without padding");
+
+    struct BuiltEventTableEntry
+    {
+        uint32_t trigger_counter;
+        uint32_t flags; // IncompleteFlag if fragments were missing or duplicated when it was built
+        uint64_t address; // of the record in byte
+        uint64_t length;  // of the record in byte
+
+        inline static const uint32_t IncompleteFlag = 0x1;
+    };
+    static_assert(sizeof(BuiltEventTableEntry) == 24, "BuiltEventTableEntry must be packed without padding");
+
+    // Write the events from EventBuilder into a file.
+    // The file is written to "<path>.tmp" and renamed to _path by Close(), so that readers do not see a partial file.
+    class BuiltEventFileWriter
+    {
+    public:
+        BuiltEventFileWriter(const std::string &_path, uint32_t _run_id);
+        ~BuiltEventFileWriter();
+
+        BuiltEventFileWriter(const BuiltEventFileWriter &) = delete;
+        BuiltEventFileWriter &operator=(const BuiltEventFileWriter &) = delete;
+
+        bool IsGood() const { return fOut.good(); }
+
+        // Append the fragments of _event
+        bool Write(const StreamedBuiltEventBase &_event);
+
+        // Write the table and the header. Return false if the file could not be written.
+        bool Close();
+
+        uint64_t GetNumberOfBytesWritten() const { return fAddress; }
+
+    private:
+        std::string fPath;
+        std::string fTmpPath;
+        uint32_t fRunId;
+        std::ofstream fOut;
+        uint64_t fAddress; // End of the records
+        std::vector<BuiltEventTableEntry> fTable;
+        bool fClosed;
+    };
+
+    // Reader of the file written by BuiltEventFileWriter. The table is loaded when it is opened.
+    class BuiltEventFile
+    {
+    public:
+        BuiltEventFile(const std::string &_path);
+        ~BuiltEventFile();
+
+        BuiltEventFile(const BuiltEventFile &) = delete;
+        BuiltEventFile &operator=(const BuiltEventFile &) = delete;
+
+        // True if the header and the table are valid
+        bool IsGood() const { return fGood; }
+        uint32_t GetRunId() const { return fHeader.run_id; }
+        uint64_t GetNumberOfEvents() const { return fTable.size(); }
+        const std::vector<BuiltEventTableEntry> &GetTable() const { return fTable; }
+
+        // Entry of the event with _triggerCounter, or nullptr if not found
+        const BuiltEventTableEntry *Find(uint32_t _triggerCounter) const;
+
+        // Read the fragments of the event with a single pread(). Return false if not found or not readable.
+        bool ReadEvent(const BuiltEventTableEntry &_entry, std::vector<StoredFragment> &_fragments) const;
+        bool ReadEvent(uint32_t _triggerCounter, std::vector<StoredFragment> &_fragments) const;
+
+        // Read and decode the event into _event (of any mapping policy). Return false if not found or any fragment is rejected.
+        bool ReadEvent(uint32_t _triggerCounter, BuiltEventStore &_event) const;
+
+    private:
+        bool fGood;
+        int fFd;
+        BuiltEventFileHeader fHeader;
+        std::vector<BuiltEventTableEntry> fTable;
+
+        // Read _nBytes from _address. Return false if not all of them are read.
+        bool ReadBytes(void *_buffer, std::size_t _nBytes, uint64_t _address) const;
+    };
+}
\ No newline at end of file
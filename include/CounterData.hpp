@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "DecoderFormat.hpp"
+#include "WordsView.hpp"
 
 namespace MAIKo2Decoder
 {
@@ -13,7 +14,7 @@ namespace MAIKo2Decoder
         CounterData()
             : fGood(false), fTriggerCounter(0x00000000),
               fClockCounter(0x00000000), fCounter2(0x00000000){};
-        CounterData(const std::vector<WordType> &_words);
+        CounterData(WordsView _words);
 
         bool IsGood() const { return fGood; };
         WordType GetTriggerCounter() const { return fTriggerCounter; };
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+
+#include "DecoderFormat.hpp"
+
+namespace MAIKo2Decoder
+{
+
+    enum class DecodeErrorCode : uint8_t
+    {
+        None = 0,
+        FADCLengthNotEven,       // The length of FADC data is not 2n
+        FADCSampleFormat,        // Format or channel bits of a FADC sample are wrong
+        TPCLengthNotMultipleOf5, // The length of TPC data is not 5n
+        TPCClockHeaderFormat,    // Header word of a TPC clock is wrong
+    };
+
+    struct DecodeError
+    {
+        DecodeErrorCode code;
+        uint32_t offset;               // Clock index of the bad clock, or the length of the data for length errors
+        uint32_t nWords;               // Number of valid words in words
+        std::array<WordType, 5> words; // Words of the bad clock
+    };
+
+    // Compact, bounded error record of a decoder.
+    // Every error is counted but only the first MaxRecordedErrors ones are kept in detail.
+    // Nothing is allocated while no error occurs.
+    class DecodeErrorLog
+    {
+    public:
+        inline static const std::size_t MaxRecordedErrors = 16;
+
+        DecodeErrorLog() : fNumberOfErrors(0), fErrors() {}
+
+        void Add(DecodeErrorCode _code, uint32_t _offset,
+                 const WordType *_words = nullptr, uint32_t _nWords = 0)
+        {
+            ++fNumberOfErrors;
+            if (fErrors.size() >= MaxRecordedErrors)
+                return;
+            DecodeError error{_code, _offset, 0, {}};
+            for (uint32_t i = 0; i < _nWords && i < error.words.size(); ++i)
+                error.words[i] = _words[i];
+            error.nWords = (_nWords < error.words.size()) ? _nWords : error.words.size();
+            fErrors.push_back(error);
+        }
+
+        bool IsEmpty() const { return fNumberOfErrors == 0; }
+        // Number of all errors, including those not recorded in detail
+        std::size_t GetNumberOfErrors() const { return fNumberOfErrors; }
+        bool IsTruncated() const { return fNumberOfErrors > fErrors.size(); }
+        const std::vector<DecodeError> &GetErrors() const { return fErrors; }
+
+    private:
+        std::size_t fNumberOfErrors;
+        std::vector<DecodeError> fErrors;
+    };
+}
\ No newline at end of file
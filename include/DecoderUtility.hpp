@@ -1,8 +1,10 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 #include <fstream>
 #include <map>
+#include <string>
 
 #include "DecoderFormat.hpp"
 
@@ -12,6 +14,16 @@ namespace MAIKo2Decoder
     // Return given 32-bit word in raw data, which is originally encoded in big endian, in right byte order.
     WordType CorrectRawWord(const WordType &_wordIn);
 
+    // Correct byte order of _nWords raw words in _words in place.
+    // SSSE3/AVX2 shuffles are used if the CPU supports them.
+    void CorrectRawWords(WordType *_words, std::size_t _nWords);
+
+    // Copy _nWords raw words from _src to _dst with their byte order corrected.
+    void CorrectRawWords(const WordType *_src, WordType *_dst, std::size_t _nWords);
+
+    // Name of the kernel used in CorrectRawWords() on this CPU ("avx2", "ssse3" or "scalar")
+    std::string GetCorrectRawWordsKernelName();
+
     // - Proceed the file pointer in raw-data file for 32-bit (1 word).
     // - Return byte-order corrected word read.
     WordType ReadNextWord(std::ifstream &_fIn);
@@ -0,0 +1,162 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <utility>
+
+#include "EventWordsBuffer.hpp"
+#include "MappedFile.hpp"
+#include "StreamRawData.hpp"
+#include "BuiltEventData.hpp"
+
+namespace MAIKo2Decoder
+{
+
+    // Event of a board read by BoardEventScanner
+    struct ScannedFragment
+    {
+        uint32_t plane_id = 0;
+        uint32_t board_id = 0;
+        uint32_t file_number = 0;
+        uint64_t event_id = 0;           // the order of the event in the file (begin from 1), same as StreamRawData()
+        uint64_t event_data_address = 0; // in byte
+        uint32_t trigger_counter = 0;
+        EventWordsBuffer words;
+        double read_seconds = 0.; // Framing and copying the words
+    };
+
+    // Pull-based scanner of the events of a board over its raw data files (file_number 0, 1, ...).
+    // Events are framed in the same way as StreamRawData() on the memory-mapped files, one at a time.
+    // A file ends at the first error as StreamRawData() does, and the next file follows.
+    class BoardEventScanner
+    {
+    public:
+        BoardEventScanner(uint32_t _plane_id, uint32_t _board_id, std::vector<std::string> _filePaths);
+
+        uint32_t GetPlaneId() const { return fPlaneId; }
+        uint32_t GetBoardId() const { return fBoardId; }
+
+        // Read the next event into _fragment. Return false after the last event of the last file.
+        bool Next(ScannedFragment &_fragment);
+
+        // Results of the files scanned to the end (or the error) so far, in the same form as those of StreamRawData()
+        const std::vector<StreamRawDataResult> &GetFileResults() const { return fFileResults; }
+
+    private:
+        uint32_t fPlaneId;
+        uint32_t fBoardId;
+        std::vector<std::string> fFilePaths;
+        std::size_t fFileIndex; // File being scanned (fFilePaths.size() after the last one)
+        MappedFile fFile;
+        std::size_t fPos; // Position of the next event in fFile in words (NoWordPosition before the file is opened)
+        StreamRawDataResult fResult;
+        std::vector<StreamRawDataResult> fFileResults;
+
+        // Open fFilePaths[fFileIndex]. Return false if it has no event to scan.
+        bool OpenFile();
+        void CloseFile();
+    };
+
+    // Paths of the raw data files _pathOfFile(0), _pathOfFile(1), ... up to the first one not found
+    std::vector<std::string> ListRawDataFiles(const std::function<std::string(uint32_t)> &_pathOfFile);
+
+    struct BoardOfFragment
+    {
+        uint32_t plane_id;
+        uint32_t board_id;
+    };
+
+    // Event emitted by EventBuilder, apart from the event built, which depends on the mapping (see BasicStreamedBuiltEvent)
+    struct StreamedBuiltEventBase
+    {
+        uint32_t trigger_counter = 0;
+        std::vector<ScannedFragment> fragments;           // Fragments in the order of the scanners (without duplicates)
+        std::vector<BoardOfFragment> missing_fragments;   // Boards without a fragment of the event
+        std::vector<BoardOfFragment> duplicate_fragments; // Boards with more than one fragment (only the first one is built) or rejected by BuiltEventData
+        std::vector<FragmentTiming> fragment_timings;     // in the order of fragments
+        double build_seconds = 0.;                        // Wall time of reading, decoding and building the event
+        bool IsComplete() const { return missing_fragments.empty() && duplicate_fragments.empty(); }
+
+        // Keep the capacities for the next event
+        void Clear()
+        {
+            trigger_counter = 0;
+            fragments.clear();
+            missing_fragments.clear();
+            duplicate_fragments.clear();
+            fragment_timings.clear();
+            build_seconds = 0.;
+        }
+    };
+
+    // Event emitted by EventBuilder, built with the strip and channel mapping given by MappingPolicy (see BasicBuiltEventData)
+    template <class MappingPolicy = BoardOffsetMapping>
+    struct BasicStreamedBuiltEvent : public StreamedBuiltEventBase
+    {
+        BasicBuiltEventData<MappingPolicy> event; // Built from the fragments if EventBuilder decodes them
+
+        BasicStreamedBuiltEvent() = default;
+        explicit BasicStreamedBuiltEvent(BasicBuiltEventData<MappingPolicy> _event) : event(std::move(_event)) {}
+
+        // Keep the capacities and the tables of event for the next event
+        void Clear()
+        {
+            StreamedBuiltEventBase::Clear();
+            event.Clear();
+        }
+    };
+
+    using StreamedBuiltEvent = BasicStreamedBuiltEvent<BoardOffsetMapping>;
+    using MappedStreamedBuiltEvent = BasicStreamedBuiltEvent<FunctionMapping>;
+
+    // Streaming event builder without DB.
+    // The events of the boards (each in the order of the trigger counter) are merged by the trigger counter with a min-heap
+    // holding the next fragment of each board, so that a run is built in a sequential pass over every file.
+    // Trigger counters wrapping around in a run are not supported.
+    // With a pool, the fragments of an event are decoded and the next fragments of their boards are read concurrently
+    // (a task per board), and merged into the event in the calling thread. Next() must not be called from a task of the pool.
+    class EventBuilder
+    {
+    public:
+        // Without _decodeFragments, only the words of the fragments are merged, e.g. to be stored.
+        EventBuilder(uint32_t _run_id, std::vector<BoardEventScanner> _scanners, bool _decodeFragments = true,
+                     WorkStealingPool *_pool = nullptr);
+
+        // Build the event with the next smallest trigger counter into _event. Return false when all boards are consumed.
+        template <class MappingPolicy>
+        bool Next(BasicStreamedBuiltEvent<MappingPolicy> &_event) { return BuildNext(_event, _event.event); }
+
+        const std::vector<BoardEventScanner> &GetScanners() const { return fScanners; }
+
+        uint64_t GetNumberOfEventsBuilt() const { return fNumberOfEventsBuilt; }
+        uint64_t GetNumberOfIncompleteEvents() const { return fNumberOfIncompleteEvents; }
+
+    private:
+        uint32_t fRunId;
+        std::vector<BoardEventScanner> fScanners;
+        bool fDecodeFragments;
+        WorkStealingPool *fPool; // Not owned
+        std::vector<ScannedFragment> fHeads; // Next fragment of each scanner
+
+        // Work space of Next(), sized by the number of scanners
+        std::vector<char> fTaken;                  // [scanner]
+        std::vector<std::size_t> fScannersTaken;   // [fragment]
+        std::vector<FragmentedEventData> fDecoded; // [fragment]
+        std::vector<char> fHasNext;                // [fragment]
+
+        // (trigger counter, index of the scanner). Ties are broken by the index, so that boards come in order.
+        using HeapItem = std::pair<uint32_t, std::size_t>;
+        std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> fHeap;
+
+        uint64_t fNumberOfEventsBuilt;
+        uint64_t fNumberOfIncompleteEvents;
+
+        // Read the next fragment of the scanner _index into the heap
+        void Advance(std::size_t _index);
+
+        // Next() without the mapping : the fragments into _event and the event built from them into _built
+        bool BuildNext(StreamedBuiltEventBase &_event, BuiltEventStore &_built);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include <pqxx/pqxx>
+
+#include "BatchedEventReader.hpp"
+
+// Queries of the index tables resolving the locations of fragments for BatchedEventReader.
+// Header only, so that the library itself does not depend on pqxx.
+namespace MAIKo2Decoder
+{
+    // SELECT the fragments of the run $1 satisfying _predicate on the raw events table "e"
+    inline std::string MakeFragmentLocationsQuery(const std::string &_eventsTable, const std::string &_filesTable,
+                                                  const std::string &_predicate)
+    {
+        std::ostringstream query;
+        query << "SELECT "
+              << "e.run_id, e.plane_id, e.board_id, f.file_path, "
+              << "e.event_data_address, e.event_data_length, "
+              << "e.event_fadc_words_offset, e.event_tpc_words_offset, e.event_trigger_counter "
+              << "FROM " << _eventsTable << " AS e "
+              << "INNER JOIN " << _filesTable << " AS f ON "
+              << "e.run_id = f.run_id AND "
+              << "e.plane_id = f.plane_id AND "
+              << "e.board_id = f.board_id AND "
+              << "e.file_number = f.file_number "
+              << "WHERE "
+              << "e.run_id = $1 AND " << _predicate << " "
+              << "ORDER BY f.file_path, e.event_data_address"
+              << ";";
+        return query.str();
+    }
+
+    inline std::vector<FragmentLocation> ToFragmentLocations(const pqxx::result &_res)
+    {
+        std::vector<FragmentLocation> locations;
+        locations.reserve(_res.size());
+        for (auto row : _res)
+        {
+            FragmentLocation loc;
+            loc.run_id = row[0].as<decltype(loc.run_id)>();
+            loc.plane_id = row[1].as<decltype(loc.plane_id)>();
+            loc.board_id = row[2].as<decltype(loc.board_id)>();
+            loc.file_path = row[3].as<decltype(loc.file_path)>();
+            loc.event_data_address = row[4].as<decltype(loc.event_data_address)>();
+            loc.event_data_length = row[5].as<decltype(loc.event_data_length)>();
+            loc.event_fadc_words_offset = row[6].as<decltype(loc.event_fadc_words_offset)>();
+            loc.event_tpc_words_offset = row[7].as<decltype(loc.event_tpc_words_offset)>();
+            loc.event_trigger_counter = row[8].as<decltype(loc.event_trigger_counter)>();
+            locations.push_back(loc);
+        }
+        return locations;
+    }
+
+    // Fragments of the events with _triggerCounters in a single query (= ANY of an array)
+    inline std::vector<FragmentLocation> QueryFragmentLocations(pqxx::transaction_base &_tx,
+                                                                const std::string &_eventsTable, const std::string &_filesTable,
+                                                                uint32_t _runId, const std::vector<uint32_t> &_triggerCounters)
+    {
+        std::vector<int64_t> triggerCounters(_triggerCounters.begin(), _triggerCounters.end()); // bigint[]
+        return ToFragmentLocations(_tx.exec_params(MakeFragmentLocationsQuery(_eventsTable, _filesTable,
+                                                                              "e.event_trigger_counter = ANY($2)"),
+                                                   _runId, triggerCounters));
+    }
+
+    // Fragments of the events with the trigger counters in [_first, _last]
+    inline std::vector<FragmentLocation> QueryFragmentLocations(pqxx::transaction_base &_tx,
+                                                                const std::string &_eventsTable, const std::string &_filesTable,
+                                                                uint32_t _runId, uint32_t _first, uint32_t _last)
+    {
+        return ToFragmentLocations(_tx.exec_params(MakeFragmentLocationsQuery(_eventsTable, _filesTable,
+                                                                              "e.event_trigger_counter BETWEEN $2 AND $3"),
+                                                   _runId, _first, _last));
+    }
+}
\ No newline at end of file
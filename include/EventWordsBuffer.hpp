@@ -1,8 +1,10 @@
 #pragma once
 #include <vector>
 #include <stdexcept>
+#include <utility>
 
 #include "DecoderFormat.hpp"
+#include "WordsView.hpp"
 
 namespace MAIKo2Decoder
 {
@@ -14,8 +16,9 @@ namespace MAIKo2Decoder
             : fValid(false), fWords(0),
               fEventFADCWordsOffset(0), fEventTPCWordsOffset(0) {}
 
-        EventWordsBuffer(const std::vector<WordType> &_fWords)
-            : fValid(false), fWords(_fWords),
+        // Pass the words with std::move() to avoid copying them.
+        EventWordsBuffer(std::vector<WordType> _fWords)
+            : fValid(false), fWords(std::move(_fWords)),
               fEventFADCWordsOffset(0), fEventTPCWordsOffset(0)
         {
             auto result = EventValidation(fWords);
@@ -30,10 +33,10 @@ namespace MAIKo2Decoder
             }
         }
 
-        EventWordsBuffer(const std::vector<WordType> &_fWords,
+        EventWordsBuffer(std::vector<WordType> _fWords,
                          unsigned int _fEventFADCWordsOffset,
                          unsigned int _fEventTPCWordsOffset)
-            : fValid(false), fWords(_fWords),
+            : fValid(false), fWords(std::move(_fWords)),
               fEventFADCWordsOffset(_fEventFADCWordsOffset), fEventTPCWordsOffset(_fEventTPCWordsOffset)
         {
             if (CheckIndex(fWords, _fEventFADCWordsOffset, _fEventTPCWordsOffset))
@@ -44,13 +47,15 @@ namespace MAIKo2Decoder
 
         bool IsValid() const { return fValid; }
 
-        std::vector<WordType> GetWords() const { return fWords; };
+        const std::vector<WordType> &GetWords() const { return fWords; };
         unsigned int GetEventFADCWordsOffset() const { return fEventFADCWordsOffset; }
         unsigned int GetEventTPCWordsOffset() const { return fEventTPCWordsOffset; }
 
-        std::vector<WordType> GetCounterWords() const;
-        std::vector<WordType> GetFADCWords() const;
-        std::vector<WordType> GetTPCWords() const;
+        // Views of each section in the buffer (no copy).
+        // Valid only while this buffer is alive.
+        WordsView GetCounterWords() const;
+        WordsView GetFADCWords() const;
+        WordsView GetTPCWords() const;
 
         struct ValidationResult
         {
@@ -63,10 +68,10 @@ namespace MAIKo2Decoder
 
         // Validate if the event buffer obeys the data format
         // If valid, make word index (FADC & TPC word offsets)
-        static ValidationResult EventValidation(const std::vector<WordType> &_fWords);
+        static ValidationResult EventValidation(WordsView _fWords);
 
         // Check if the event buffer can be divided into CounterData, FADCData, and TPCData.
-        static bool CheckIndex(const std::vector<WordType> &_fWords,
+        static bool CheckIndex(WordsView _fWords,
                                unsigned int _fEventFADCWordOffset, unsigned int _fEventTPCWordOffset);
 
     private:
@@ -3,7 +3,10 @@
 #include <vector>
 #include <array>
 #include <string>
+#include <cstddef>
 #include "DecoderFormat.hpp"
+#include "WordsView.hpp"
+#include "DecodeErrorLog.hpp"
 
 namespace MAIKo2Decoder
 {
@@ -11,10 +14,12 @@ namespace MAIKo2Decoder
     {
     public:
         using ShortWordType = uint16_t;
-        FADCData() : fGood(false), fEmpty(true), fSignals(), fErrorLog() {}
-        FADCData(const std::vector<WordType> &_words);
+        FADCData() : fGood(false), fEmpty(true), fSignals(), fErrors() {}
+        FADCData(WordsView _words);
         FADCData(const FADCData &_rhs);
         FADCData &operator=(const FADCData &_rhs);
+        FADCData(FADCData &&_rhs) noexcept;
+        FADCData &operator=(FADCData &&_rhs) noexcept;
 
         bool IsGood() const { return fGood; };
         bool IsEmpty() const { return fEmpty; };
@@ -26,16 +31,36 @@ namespace MAIKo2Decoder
                 return fSignals.at(_ch);
         }
 
-        std::string GetErrorLog() const { return fErrorLog; };
+        // Errors in compact form
+        const DecodeErrorLog &GetErrors() const { return fErrors; };
+        // Errors formatted in text (formatted on each call)
+        std::string GetErrorLog() const;
         inline static const uint32_t NumberOfChannels = 4;
 
+        // Length and format checks only, without unpacking the signals.
+        // Return the same as FADCData(_words).IsGood().
+        static bool CheckStructure(WordsView _words);
+
     private:
         bool fGood;
         bool fEmpty;
         std::array<std::vector<ShortWordType>, NumberOfChannels> fSignals;
-        std::string fErrorLog;
+        DecodeErrorLog fErrors;
         static bool CheckFormat(const ShortWordType &_sWord) { return (_sWord & 0xc000) == 0x4000; }
         static int GetChannel(const ShortWordType &_sWord) { return (_sWord & 0x3000) >> 12; }
         static ShortWordType GetSignal(const ShortWordType &_sWord) { return (_sWord & 0x03ff); }
+        static bool CheckClock(WordType _word1, WordType _word2)
+        {
+            const ShortWordType sWord0 = (_word1 & 0xffff0000) >> 16;
+            const ShortWordType sWord1 = (_word1 & 0x0000ffff);
+            const ShortWordType sWord2 = (_word2 & 0xffff0000) >> 16;
+            const ShortWordType sWord3 = (_word2 & 0x0000ffff);
+            return CheckFormat(sWord0) && GetChannel(sWord0) == 0 &&
+                   CheckFormat(sWord1) && GetChannel(sWord1) == 1 &&
+                   CheckFormat(sWord2) && GetChannel(sWord2) == 2 &&
+                   CheckFormat(sWord3) && GetChannel(sWord3) == 3;
+        }
+        // Unpack a clock (2 words) into the signals at _pos. Return false with an error recorded if it is in the wrong format.
+        bool UnpackClock(WordType _word1, WordType _word2, std::size_t _clock, std::size_t _pos);
     };
 }
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace MAIKo2Decoder
+{
+    // Size, modification time and a fast content fingerprint of a file,
+    // to tell whether a file has changed since it was indexed without reading the whole file.
+    struct FileFingerprint
+    {
+        bool good = false;        // false if the file could not be read
+        uint64_t size = 0;        // in byte
+        int64_t mtime = 0;        // modification time in ns since the epoch
+        uint64_t fingerprint = 0; // FNV-1a hash of the size, the first and the last NumberOfBytesHashed bytes
+        inline static const uint64_t NumberOfBytesHashed = 1 << 16; // 64 KiB each
+    };
+
+    const uint64_t FNV1aOffsetBasis = 0xcbf29ce484222325;
+
+    // 64-bit FNV-1a hash of _nBytes bytes, continued from _hash
+    uint64_t HashBytesFNV1a(const void *_bytes, std::size_t _nBytes, uint64_t _hash = FNV1aOffsetBasis);
+
+    // Fingerprint of the whole file
+    FileFingerprint TakeFileFingerprint(const std::string &_filePath);
+
+    // Fingerprint of the first _size bytes of the file, as if the file were truncated at _size.
+    // Equal to the fingerprint taken when the file was _size bytes long, if the file has only grown since then.
+    // Not good if the file is shorter than _size.
+    FileFingerprint TakeFileFingerprint(const std::string &_filePath, uint64_t _size);
+}
\ No newline at end of file
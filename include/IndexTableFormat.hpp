@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <tuple>
 
 namespace MAIKo2Decoder
 {
@@ -17,6 +18,13 @@ namespace MAIKo2Decoder
         uint32_t event_tpc_words_offset;
         uint32_t event_clock_counter;
         uint32_t event_trigger_counter;
+
+        // True if _lhs comes before _rhs in the order of the primary key (run_id, plane_id, board_id, file_number, event_id)
+        static bool ComparePrimaryKey(const RawEventsRecord &_lhs, const RawEventsRecord &_rhs)
+        {
+            return std::tie(_lhs.run_id, _lhs.plane_id, _lhs.board_id, _lhs.file_number, _lhs.event_id) <
+                   std::tie(_rhs.run_id, _rhs.plane_id, _rhs.board_id, _rhs.file_number, _rhs.event_id);
+        }
     };
 
     struct RawFilesRecord
@@ -25,7 +33,10 @@ namespace MAIKo2Decoder
         uint32_t plane_id;
         uint32_t board_id;
         uint32_t file_number;
-        std::string file_path; // varchar(100)
+        std::string file_path;    // varchar(100)
+        uint64_t file_size;       // in byte, when the file was indexed
+        int64_t file_mtime;       // modification time in ns since the epoch
+        int64_t file_fingerprint; // bits of FileFingerprint::fingerprint (bigint)
         inline static const unsigned int LengthLimitOfFilePath = 100;
     };
 
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace MAIKo2Decoder
+{
+
+    // Read-only memory mapping of a whole file.
+    // The mapping is released when the object is destroyed.
+    class MappedFile
+    {
+    public:
+        MappedFile() : fGood(false), fData(nullptr), fSize(0) {}
+        MappedFile(const std::string &_filePath);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&_rhs) noexcept;
+        MappedFile &operator=(MappedFile &&_rhs) noexcept;
+
+        // True if the file was opened and mapped (an empty file is good with no data).
+        bool IsGood() const { return fGood; }
+        const char *GetData() const { return fData; }
+        uint64_t GetSize() const { return fSize; }
+
+        // Hint the kernel that the mapping is read from the beginning to the end.
+        void AdviseSequential() const;
+        // Hint the kernel that the mapping is read at random positions (no read-ahead).
+        void AdviseRandom() const;
+
+    private:
+        bool fGood;
+        char *fData;
+        uint64_t fSize;
+        void Release();
+    };
+}
\ No newline at end of file
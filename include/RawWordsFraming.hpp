@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "DecoderFormat.hpp"
+
+namespace MAIKo2Decoder
+{
+    // Helpers for framing events directly on the raw (big-endian, NOT byte-order corrected) words
+    // of a raw-data file, e.g. on a memory-mapped file.
+
+    // Return _word with its byte order reversed.
+    constexpr WordType SwapWordBytes(WordType _word)
+    {
+        return ((_word & 0xff000000) >> 24) |
+               ((_word & 0x00ff0000) >> 8) |
+               ((_word & 0x0000ff00) << 8) |
+               ((_word & 0x000000ff) << 24);
+    }
+
+    // Event header and footer as they appear in the raw-data file
+    const WordType RawEventHeader = SwapWordBytes(EventHeader);
+    const WordType RawEventFooter = SwapWordBytes(EventFooter);
+
+    // Returned by the functions below when nothing is found.
+    const std::size_t NoWordPosition = static_cast<std::size_t>(-1);
+
+    // Return the position of the first _rawPattern in _raw[_begin, _end), or _end if not found.
+    // Words are compared 16 at a time with SSE2/AVX2 if available, so that a search runs at memory bandwidth.
+    std::size_t FindRawWord(const WordType *_raw, std::size_t _begin, std::size_t _end, WordType _rawPattern);
+
+    // Return the position of the first event header in _raw[0, _nWords), or NoWordPosition if not found.
+    std::size_t FindFirstEventHeader(const WordType *_raw, std::size_t _nWords);
+
+    // Return the position next to the footer of the event beginning at _posHeader, or NoWordPosition if not found.
+    // strict check : the footer must be followed by the header of the next event or the end of _raw.
+    std::size_t FindEventEnd(const WordType *_raw, std::size_t _nWords, std::size_t _posHeader);
+
+    // Return the position of the first event header at or after _pos, or NoWordPosition if not found.
+    // _pos must be after the first event header in _raw. As events are contiguous from there, the header must follow
+    // a footer (strict check), so that a header-like word in TPC data is not taken. Used to resync at any position.
+    std::size_t FindNextEventHeader(const WordType *_raw, std::size_t _nWords, std::size_t _pos);
+
+    // Append to _boundaries the positions next to every footer in _raw[_begin, _end) passing the strict check
+    // (followed by a header or the end of _raw), in ascending order.
+    // Once the first header is found, events are contiguous and each of them ends at the first such position after its header.
+    // Thus, events can be framed on any part of a file independently, which enables parallel framing.
+    void FindEventBoundaries(const WordType *_raw, std::size_t _nWords, std::size_t _begin, std::size_t _end,
+                             std::vector<std::size_t> &_boundaries);
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "IndexTableFormat.hpp"
+#include "MappedFile.hpp"
+
+namespace MAIKo2Decoder
+{
+    // Binary index of the events in a raw data file, written next to it ("<raw file>.idx").
+    // Events can be looked up without the DB by memory-mapping it.
+    //
+    // Layout (host byte order) :
+    //     SidecarIndexHeader
+    //     SidecarIndexRecord x number_of_records, sorted by event_trigger_counter (then event_id)
+
+    struct SidecarIndexHeader
+    {
+        char magic[8];              // "MK2SIDX"
+        uint32_t version;           // Version
+        uint32_t record_size;       // sizeof(SidecarIndexRecord)
+        uint64_t number_of_records;
+        uint64_t raw_file_size;     // in byte, when the file was indexed
+        uint64_t checksum;          // HashBytesFNV1a() of the records
+        uint64_t reserved;
+
+        inline static const char Magic[8] = "MK2SIDX";
+        inline static const uint32_t Version = 1;
+    };
+    static_assert(sizeof(SidecarIndexHeader) == 48, "SidecarIndexHeader must be packed without padding");
+
+    struct SidecarIndexRecord
+    {
+        uint64_t event_id;
+        uint64_t event_data_address;
+        uint32_t event_data_length;
+        uint32_t event_fadc_words_offset;
+        uint32_t event_tpc_words_offset;
+        uint32_t event_clock_counter;
+        uint32_t event_trigger_counter;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(SidecarIndexRecord) == 40, "SidecarIndexRecord must be packed without padding");
+
+    // Path of the sidecar index of the raw data file at _rawFilePath
+    std::string GetSidecarIndexPath(const std::string &_rawFilePath);
+
+    // Write the sidecar index of _records (events of a raw data file of _rawFileSize bytes) to _path.
+    // It is written into a temporary file renamed to _path, so that readers never see a partial index.
+    // Return false if it could not be written.
+    bool WriteSidecarIndex(const std::string &_path, const std::vector<RawEventsRecord> &_records, uint64_t _rawFileSize);
+
+    // Memory-mapped sidecar index
+    class SidecarIndex
+    {
+    public:
+        SidecarIndex() : fGood(false), fFile(), fHeader(nullptr), fRecords(nullptr) {}
+        // Map and verify (header and checksum) the sidecar index at _path.
+        SidecarIndex(const std::string &_path);
+
+        // True if the index was mapped and verified
+        bool IsGood() const { return fGood; }
+        uint64_t GetNumberOfRecords() const { return fGood ? fHeader->number_of_records : 0; }
+        uint64_t GetRawFileSize() const { return fGood ? fHeader->raw_file_size : 0; }
+
+        // Records in the order of trigger counter (valid while this object is alive)
+        const SidecarIndexRecord *begin() const { return fRecords; }
+        const SidecarIndexRecord *end() const { return fRecords + GetNumberOfRecords(); }
+
+        // Records with _triggerCounter found by binary search, as [first, second)
+        std::pair<const SidecarIndexRecord *, const SidecarIndexRecord *> FindByTriggerCounter(uint32_t _triggerCounter) const;
+
+        // All records in the order of event_id, e.g. to resume indexing the file
+        std::vector<RawEventsRecord> GetRecordsInEventOrder(uint32_t _runId, uint32_t _planeId, uint32_t _boardId, uint32_t _fileNumber) const;
+
+    private:
+        bool fGood;
+        MappedFile fFile;
+        const SidecarIndexHeader *fHeader;
+        const SidecarIndexRecord *fRecords;
+    };
+}
\ No newline at end of file
@@ -8,9 +8,25 @@
 namespace MAIKo2Decoder
 {
 
+    // Engine used to read the raw-data file
+    enum class StreamRawDataEngine
+    {
+        IFStream,  // std::ifstream
+        MemoryMap, // mmap() the whole file and frame events on the mapped bytes
+    };
+
     struct StreamRawDataInput
     {
         std::string fileName;
+        StreamRawDataEngine engine = StreamRawDataEngine::IFStream;
+        // Resume streaming from the middle of the file, e.g. from the end of the events already processed.
+        // If start_address is not 0, an event header must be at start_address (otherwise invalidHeader).
+        uint64_t start_address = 0;  // in byte (multiple of 4)
+        uint64_t first_event_id = 1; // event_id of the event at start_address
+        // The file is still being written. A footer at the end of the file may be data of an event not written completely,
+        // so the event at the end is not processed (noEventFooter) until it is followed by the next header.
+        // Resume from number_of_bytes_processed when the file grows.
+        bool growing = false;
     };
 
     struct StreamRawDataResult
@@ -24,12 +40,15 @@ namespace MAIKo2Decoder
         bool eventFormatError = false;
         bool abortedByCallBack = false;
         StreamRawDataInput input;
-        uint64_t number_of_events_processed = 0;
+        uint64_t number_of_events_processed = 0; // including the event which failed, if any (from input.start_address)
+        uint64_t number_of_bytes_processed = 0;  // from the beginning of the file to the end of the last event processed
+        double elapsed_seconds = 0.;
+        double bytes_per_second = 0.;
     };
 
     struct RawEventData
     {
-        uint64_t event_id;           // the order of the events in the file (begin from 1. Should be same to trigger counter)
+        uint64_t event_id;           // the order of the events in the file (begin from input.first_event_id, 1 by default. Should be same to trigger counter)
         uint64_t event_data_address; // the address (byte) of the event in raw data file
         uint32_t event_data_length;  // the length of the word sequence in byte.
         // uint32_t event_fadc_words_offset; // the order of the word where FADC data begins. 0 if no FADC data in the event.
@@ -42,8 +61,42 @@ namespace MAIKo2Decoder
         // MAIKo2Decoder::TPCData tpc;
     };
 
-    // Stream raw-data-file named _input.file_name from its beginning.
+    struct SeekTriggerCounterResult
+    {
+        bool goodFlag = false; // The event with the trigger counter is found.
+        bool fileNotFound = false;
+        bool noEventFound = false;
+        // The first event with the trigger counter or larger. The end of the file if all events have smaller ones.
+        uint64_t event_data_address = 0; // in byte. Can be passed to StreamRawDataInput::start_address.
+        uint32_t event_data_length = 0;  // in byte. 0 if the event is not terminated.
+        uint32_t event_trigger_counter = 0;
+        unsigned int number_of_probes = 0; // Number of events whose counter was read
+    };
+
+    // Find the event with _triggerCounter in raw-data-file named _fileName without any index.
+    // Events in a file are in the order of the trigger counter, so that the file is bisected on it:
+    // each probe resyncs to the next event header at a byte offset (strict check) and reads its counter words.
+    // The file is memory-mapped and only O(log(number of events)) events are read.
+    SeekTriggerCounterResult SeekTriggerCounter(const std::string &_fileName, uint32_t _triggerCounter);
+
+    // Stream raw-data-file named _input.file_name from its beginning (or from _input.start_address).
     // _callBack function is called after each event is processed.
     StreamRawDataResult StreamRawData(StreamRawDataInput _input,
                                       std::function<bool(const RawEventData &)> _callBack);
+
+    // Stream raw-data-file named _input.file_name split into _nChunks byte ranges, which are framed and processed in parallel.
+    // A thread is started for each chunk. When this is called from the threads of a pool, keep
+    // (threads of the pool) x _nChunks within the hardware threads.
+    // The file is always memory-mapped (_input.engine is ignored).
+    // Events, their event_id and address are exactly the same as those of StreamRawData().
+    // _callBack is called concurrently from the chunks with the index of the chunk (0 -- _nChunks - 1).
+    // Within a chunk, events come in order, and chunks are in the order of the file.
+    // The result is that of StreamRawData(), i.e. number_of_events_processed stops at the first failure in the file.
+    // _callBack may have been called for events after it in other chunks,
+    // so events with event_id >= input.first_event_id + number_of_events_processed must be discarded by the caller.
+    // _chunkDone (if given) is called from each chunk after its last event with the index of the chunk and
+    // whether the chunk stopped at a failure, so that the caller can pass on the events of the chunks done in order.
+    StreamRawDataResult StreamRawDataInParallel(StreamRawDataInput _input, unsigned int _nChunks,
+                                                std::function<bool(unsigned int, const RawEventData &)> _callBack,
+                                                std::function<void(unsigned int, bool)> _chunkDone = nullptr);
 }
\ No newline at end of file
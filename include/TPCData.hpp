@@ -1,17 +1,25 @@
 #pragma once
 #include <vector>
+#include <array>
 #include <string>
+#include <iterator>
+#include <cstddef>
 #include "DecoderFormat.hpp"
+#include "WordsView.hpp"
+#include "BitOperations.hpp"
+#include "DecodeErrorLog.hpp"
 
 namespace MAIKo2Decoder
 {
     class TPCData
     {
     public:
-        TPCData() : fGood(false), fEmpty(true), fTPCHits(), fErrorLog(){};
-        TPCData(const std::vector<WordType> &_words);
+        TPCData() : fGood(false), fEmpty(true), fNumberOfHits(0), fOccupancy(), fErrors(){};
+        TPCData(WordsView _words);
         TPCData(const TPCData &_rhs);
         TPCData &operator=(const TPCData &_rhs);
+        TPCData(TPCData &&_rhs) noexcept;
+        TPCData &operator=(TPCData &&_rhs) noexcept;
 
         bool IsGood() const { return fGood; };
         bool IsEmpty() const { return fEmpty; };
@@ -25,16 +33,112 @@ namespace MAIKo2Decoder
             uint32_t clock; // y
         };
 
-        std::vector<Hit> GetHits() const { return fTPCHits; };
+        inline static const uint32_t NumberOfStrips = 128;
 
-        std::string GetErrorLog() const { return fErrorLog; };
+        // Occupancy of 128 strips in a clock (bitmap)
+        struct ClockOccupancy
+        {
+            uint32_t clock;
+            // Bit i of strips.at(k) is set if strip (32 * k + i) is hit.
+            std::array<WordType, NumberOfStrips / 32> strips;
+        };
+
+        // Forward iterator producing hits on demand from the bitmap.
+        // Hits are in the same order as GetHits().
+        class HitIterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Hit;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Hit *;
+            using reference = Hit;
+
+            HitIterator() : fIt(nullptr), fEnd(nullptr), fWordIndex(0), fBits(0) {}
+            HitIterator(const ClockOccupancy *_it, const ClockOccupancy *_end)
+                : fIt(_it), fEnd(_end), fWordIndex(NumberOfStrips / 32), fBits(0) { Settle(); }
+
+            Hit operator*() const { return Hit(fWordIndex * 32 + CountTrailingZeros(fBits), fIt->clock); }
+            HitIterator &operator++()
+            {
+                fBits &= fBits - 1; // Clear the least significant set bit
+                Settle();
+                return *this;
+            }
+            HitIterator operator++(int)
+            {
+                HitIterator tmp = *this;
+                ++(*this);
+                return tmp;
+            }
+            bool operator==(const HitIterator &_rhs) const
+            {
+                return fIt == _rhs.fIt && fWordIndex == _rhs.fWordIndex && fBits == _rhs.fBits;
+            }
+            bool operator!=(const HitIterator &_rhs) const { return !(*this == _rhs); }
+
+        private:
+            const ClockOccupancy *fIt;
+            const ClockOccupancy *fEnd;
+            unsigned int fWordIndex; // strip words are visited from 3 (strip 127 -- 096) to 0 (strip 031 -- 000)
+            WordType fBits;          // bits not visited yet in the current strip word
+
+            // Move to the next set bit if no bit is left in the current strip word
+            void Settle()
+            {
+                while (fBits == 0 && fIt != fEnd)
+                {
+                    if (fWordIndex == 0)
+                    {
+                        ++fIt;
+                        fWordIndex = NumberOfStrips / 32;
+                        continue;
+                    }
+                    --fWordIndex;
+                    fBits = fIt->strips[fWordIndex];
+                }
+            }
+        };
+
+        struct HitRange
+        {
+            HitIterator first;
+            HitIterator last;
+            HitIterator begin() const { return first; }
+            HitIterator end() const { return last; }
+        };
+
+        // All hits expanded from the bitmap
+        std::vector<Hit> GetHits() const;
+        // Expand all hits at the end of _hits
+        void AppendHits(std::vector<Hit> &_hits) const;
+        // Hits produced on demand without expanding them (valid while this object is alive)
+        HitRange GetHitRange() const
+        {
+            const ClockOccupancy *begin = fOccupancy.data();
+            const ClockOccupancy *end = fOccupancy.data() + fOccupancy.size();
+            return {HitIterator(begin, end), HitIterator(end, end)};
+        }
+        std::size_t GetNumberOfHits() const { return fNumberOfHits; };
+
+        // Bitmap of the clocks with at least one hit, in the order of the raw data
+        const std::vector<ClockOccupancy> &GetOccupancy() const { return fOccupancy; };
+
+        // Length and clock header checks only, without building the bitmap.
+        // Return the same as TPCData(_words).IsGood().
+        static bool CheckStructure(WordsView _words);
+
+        // Errors in compact form
+        const DecodeErrorLog &GetErrors() const { return fErrors; };
+        // Errors formatted in text (formatted on each call)
+        std::string GetErrorLog() const;
 
     private:
         bool fGood;
         bool fEmpty;
-        std::vector<Hit> fTPCHits;
-        // std::ostringstream fErrorLog;
-        std::string fErrorLog;
+        std::size_t fNumberOfHits;
+        std::vector<ClockOccupancy> fOccupancy;
+        DecodeErrorLog fErrors;
         static bool CheckHeaderFormat(const WordType &_word) { return (_word & 0xffff0000) == 0x80000000; }
         static unsigned int GetClock(const WordType &_word) { return (_word & 0x0000ffff); };
     };
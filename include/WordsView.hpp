@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+#include "DecoderFormat.hpp"
+
+namespace MAIKo2Decoder
+{
+
+    // Non-owning, read-only view of contiguous words (like std::span<const WordType>, which is not in C++17).
+    // The view is valid only while the viewed words are alive and not reallocated.
+    class WordsView
+    {
+    public:
+        using value_type = WordType;
+        using const_iterator = const WordType *;
+        using iterator = const_iterator;
+
+        WordsView() : fData(nullptr), fSize(0) {}
+        WordsView(const WordType *_data, std::size_t _size) : fData(_data), fSize(_size) {}
+        WordsView(const std::vector<WordType> &_words) : fData(_words.data()), fSize(_words.size()) {}
+
+        const WordType *data() const { return fData; }
+        std::size_t size() const { return fSize; }
+        bool empty() const { return fSize == 0; }
+
+        const_iterator begin() const { return fData; }
+        const_iterator end() const { return fData + fSize; }
+
+        const WordType &operator[](std::size_t _pos) const { return fData[_pos]; }
+        const WordType &at(std::size_t _pos) const
+        {
+            if (_pos >= fSize)
+                throw std::out_of_range("WordsView::at()");
+            return fData[_pos];
+        }
+        const WordType &front() const { return fData[0]; }
+        const WordType &back() const { return fData[fSize - 1]; }
+
+        // View of _count words beginning at _offset
+        WordsView SubView(std::size_t _offset, std::size_t _count) const
+        {
+            if (_offset > fSize || _count > fSize - _offset)
+                throw std::out_of_range("WordsView::SubView()");
+            return WordsView(fData + _offset, _count);
+        }
+
+        std::vector<WordType> ToVector() const { return std::vector<WordType>(begin(), end()); }
+
+    private:
+        const WordType *fData;
+        std::size_t fSize;
+    };
+}
\ No newline at end of file
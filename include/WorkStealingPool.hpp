@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <future>
+
+namespace MAIKo2Decoder
+{
+
+    // Fixed-size thread pool with a task queue per worker.
+    // A worker runs its own tasks last-in first-out and, when it has none, steals the oldest task of another worker,
+    // so that the load is rebalanced while running even if the tasks differ in size.
+    class WorkStealingPool
+    {
+    public:
+        // _nThreads == 0 : std::thread::hardware_concurrency()
+        explicit WorkStealingPool(unsigned int _nThreads = 0);
+        // All tasks submitted are finished before the workers are joined.
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        // Run _func in the pool. A task submitted from a worker is queued to the worker itself.
+        // Do not wait for the future of a task in another task; it may never run.
+        template <typename Func>
+        auto Submit(Func &&_func) -> std::future<decltype(_func())>
+        {
+            using ResultType = decltype(_func());
+            auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Func>(_func));
+            auto future = task->get_future();
+            Push([task]()
+                 { (*task)(); });
+            return future;
+        }
+
+        unsigned int GetNumberOfThreads() const { return fThreads.size(); }
+        // Number of tasks run by a worker other than the one they were queued to
+        uint64_t GetNumberOfSteals() const { return fNumberOfSteals; }
+
+    private:
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> fQueues;
+        std::vector<std::thread> fThreads;
+        std::mutex fMutex; // for fNumberOfQueuedTasks and fStop
+        std::condition_variable fCondition;
+        std::size_t fNumberOfQueuedTasks;
+        bool fStop;
+        std::atomic<unsigned int> fNextQueue; // Round robin for tasks submitted from outside
+        std::atomic<uint64_t> fNumberOfSteals;
+
+        void Push(std::function<void()> _task);
+        bool TryPop(unsigned int _index, std::function<void()> &_task);
+        void Run(unsigned int _index);
+    };
+}
\ No newline at end of file
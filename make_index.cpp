@@ -2,10 +2,17 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <algorithm>
 #include <future>
 #include <functional>
 #include <iomanip>
+#include <memory>
+#include <chrono>
+#include <tuple>
+#include <thread>
+#include <mutex>
+#include <exception>
 
 #include <pqxx/pqxx>
 #include <nlohmann/json.hpp>
@@ -18,17 +25,93 @@
 #include "EventWordsBuffer.hpp"
 #include "StreamRawData.hpp"
 #include "IndexTableFormat.hpp"
+#include "WorkStealingPool.hpp"
+#include "BoundedQueue.hpp"
+#include "BatchWriter.hpp"
+#include "FileFingerprint.hpp"
+#include "SidecarIndex.hpp"
 
-struct ResultsOfThread
+// Results of all raw data files of a board
+struct ResultsOfBoard
 {
     uint32_t run_id;
     uint32_t plane_id;
     uint32_t board_id;
     std::vector<MAIKo2Decoder::StreamRawDataResult> stream_results;
-    std::vector<MAIKo2Decoder::RawEventsRecord> records;
     std::vector<MAIKo2Decoder::RawFilesRecord> files;
 };
 
+// A raw data file to be indexed (a task)
+struct RawFileToIndex
+{
+    uint32_t run_id;
+    uint32_t plane_id;
+    uint32_t board_id;
+    uint32_t file_number;
+    std::string file_path;
+    MAIKo2Decoder::FileFingerprint fingerprint; // taken when the file is enumerated
+    uint64_t start_address = 0;                 // not 0 to index only the tail of a grown file
+    uint64_t first_event_id = 1;                // event_id of the event at start_address
+    bool growing = false;                       // still being written by the DAQ (follow mode)
+    bool rewritten = false;                     // indexed again from the beginning : records of the former content are deleted
+
+    uint64_t GetNumberOfBytesToIndex() const { return fingerprint.size - start_address; }
+};
+
+// Results of a raw data file. Records of the events are passed to the DB writers through a queue.
+struct ResultsOfFile
+{
+    MAIKo2Decoder::StreamRawDataResult stream_result;
+    MAIKo2Decoder::RawFilesRecord file;
+};
+
+// Records of events in a raw data file, passed from the scanners to the DB writers
+struct RawEventsRecordBatch
+{
+    uint32_t run_id;
+    uint32_t plane_id;
+    uint32_t board_id;
+    uint32_t file_number;
+    std::vector<MAIKo2Decoder::RawEventsRecord> records;
+    uint64_t delete_events_from = 0; // not 0 to delete the records of the file from this event_id, in the transaction of the batch
+};
+
+// How much of each event is checked before it is indexed
+enum class ValidationLevel
+{
+    Counters,  // Event framing and counter words only
+    Structure, // + length and format of FADC and TPC words, without unpacking them
+    Full       // + FADC signals and TPC hits decoded
+};
+
+// How records are inserted (or updated) into the DB
+enum class DBInsertMode
+{
+    Insert,   // INSERT ... ON CONFLICT DO UPDATE for each record
+    Copy,     // COPY into a temporary staging table and a single INSERT ... SELECT ... ON CONFLICT DO UPDATE
+    Prepared  // Prepared multi-row INSERT ... VALUES ... ON CONFLICT DO UPDATE (neither COPY nor temporary tables needed)
+};
+
+// How each raw data file is indexed
+struct IndexOptions
+{
+    MAIKo2Decoder::StreamRawDataEngine stream_engine;
+    ValidationLevel validation_level;
+    unsigned int number_of_chunks_per_file;
+    std::size_t record_batch_size; // records pushed to the DB writers at once
+    bool write_sidecar_index;
+};
+
+const std::string ColumnsOfRawEventsTable = "run_id, plane_id, board_id, file_number, event_id, "
+                                           "event_data_address, event_data_length, "
+                                           "event_fadc_words_offset, event_tpc_words_offset, "
+                                           "event_clock_counter, event_trigger_counter";
+const std::size_t NumberOfColumnsOfRawEventsTable = 11;
+// Limited by the number of parameters in a statement (65535)
+const std::size_t MaxRowsInPreparedStatement = 65535 / NumberOfColumnsOfRawEventsTable;
+const std::string ColumnsOfRawFilesTable = "run_id, plane_id, board_id, file_number, file_path, "
+                                          "file_size, file_mtime, file_fingerprint";
+
 class Configuration
 {
 public:
@@ -74,6 +157,20 @@ public:
     std::string KeyOfNameOfRawEventsTable() const { return "nameOfRawEventsTable"; };
     std::string KeyOfNameOfPlanesTable() const { return "nameOfPlanesTable"; };
     std::string KeyOfNameOfRawFilesTable() const { return "nameOfRawFilesTable"; };
+    std::string KeyOfStreamEngine() const { return "streamEngine"; };                   // optional
+    std::string KeyOfValidationLevel() const { return "validationLevel"; };             // optional
+    std::string KeyOfNumberOfChunksPerFile() const { return "numberOfChunksPerFile"; }; // optional
+    std::string KeyOfNumberOfThreads() const { return "numberOfThreads"; };             // optional
+    std::string KeyOfNumberOfDBWriters() const { return "numberOfDBWriters"; };         // optional
+    std::string KeyOfRecordBatchSize() const { return "recordBatchSize"; };             // optional
+    std::string KeyOfRecordQueueSize() const { return "recordQueueSize"; };             // optional
+    std::string KeyOfDBInsertMode() const { return "dbInsertMode"; };                   // optional
+    std::string KeyOfDBInsertBatchSize() const { return "dbInsertBatchSize"; };         // optional
+    std::string KeyOfIncremental() const { return "incremental"; };                     // optional
+    std::string KeyOfFollow() const { return "follow"; };                               // optional
+    std::string KeyOfFollowPollingInterval() const { return "followPollingInterval"; }; // optional
+    std::string KeyOfFollowIdleTimeout() const { return "followIdleTimeout"; };         // optional
+    std::string KeyOfWriteSidecarIndex() const { return "writeSidecarIndex"; };         // optional
 
     std::string GetDataDirectoryPath() const { return fDataDirectoryPath; };
     std::string GetRawDataFileFormat() const { return fRawDataFileFormat; }
@@ -81,6 +178,34 @@ public:
     std::string GetNameOfRawEventsTable() const { return fNameOfRawEventsTable; };
     std::string GetNameOfPlanesTable() const { return fNameOfPlanesTable; }
     std::string GetNameOfRawFilesTable() const { return fNameOfRawFilesTable; }
+    MAIKo2Decoder::StreamRawDataEngine GetStreamEngine() const { return fStreamEngine; }
+    ValidationLevel GetValidationLevel() const { return fValidationLevel; }
+    unsigned int GetNumberOfChunksPerFile() const { return fNumberOfChunksPerFile; }
+    unsigned int GetNumberOfThreads() const { return fNumberOfThreads; }
+    unsigned int GetNumberOfDBWriters() const { return fNumberOfDBWriters; }
+    std::size_t GetRecordBatchSize() const { return fRecordBatchSize; }
+    std::size_t GetRecordQueueSize() const { return fRecordQueueSize; }
+    DBInsertMode GetDBInsertMode() const { return fDBInsertMode; }
+    std::size_t GetDBInsertBatchSize() const { return fDBInsertBatchSize; }
+    bool GetIncremental() const { return fIncremental; }
+    bool GetFollow() const { return fFollow; }
+    double GetFollowPollingInterval() const { return fFollowPollingInterval; }
+    double GetFollowIdleTimeout() const { return fFollowIdleTimeout; }
+    bool GetWriteSidecarIndex() const { return fWriteSidecarIndex; }
+    IndexOptions GetIndexOptions() const
+    {
+        return IndexOptions{GetStreamEngine(), GetValidationLevel(), GetNumberOfChunksPerFileInUse(),
+                            GetRecordBatchSize(), GetWriteSidecarIndex()};
+    }
+
+    // StreamRawDataInParallel() runs a thread for each chunk inside each thread of the pool indexing the files,
+    // so that numberOfChunksPerFile is limited to (hardware threads / numberOfThreads) not to oversubscribe the CPU.
+    unsigned int GetNumberOfChunksPerFileInUse() const
+    {
+        const unsigned int nHardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        const unsigned int nThreads = (fNumberOfThreads == 0) ? nHardwareThreads : fNumberOfThreads;
+        return std::max(1u, std::min(fNumberOfChunksPerFile, nHardwareThreads / nThreads));
+    }
 
     std::string Dump() const
     {
@@ -94,6 +219,20 @@ public:
         tmp << KeyOfNameOfRawEventsTable() << " : " << GetNameOfRawEventsTable() << std::endl;
         tmp << KeyOfNameOfPlanesTable() << " : " << GetNameOfPlanesTable() << std::endl;
         tmp << KeyOfNameOfRawFilesTable() << " : " << GetNameOfRawFilesTable() << std::endl;
+        tmp << KeyOfStreamEngine() << " : " << StreamEngineToString(GetStreamEngine()) << std::endl;
+        tmp << KeyOfValidationLevel() << " : " << ValidationLevelToString(GetValidationLevel()) << std::endl;
+        tmp << KeyOfNumberOfChunksPerFile() << " : " << GetNumberOfChunksPerFile() << std::endl;
+        tmp << KeyOfNumberOfThreads() << " : " << GetNumberOfThreads() << std::endl;
+        tmp << KeyOfNumberOfDBWriters() << " : " << GetNumberOfDBWriters() << std::endl;
+        tmp << KeyOfRecordBatchSize() << " : " << GetRecordBatchSize() << std::endl;
+        tmp << KeyOfRecordQueueSize() << " : " << GetRecordQueueSize() << std::endl;
+        tmp << KeyOfDBInsertMode() << " : " << DBInsertModeToString(GetDBInsertMode()) << std::endl;
+        tmp << KeyOfDBInsertBatchSize() << " : " << GetDBInsertBatchSize() << std::endl;
+        tmp << KeyOfIncremental() << " : " << std::boolalpha << GetIncremental() << std::endl;
+        tmp << KeyOfFollow() << " : " << std::boolalpha << GetFollow() << std::endl;
+        tmp << KeyOfFollowPollingInterval() << " : " << GetFollowPollingInterval() << std::endl;
+        tmp << KeyOfFollowIdleTimeout() << " : " << GetFollowIdleTimeout() << std::endl;
+        tmp << KeyOfWriteSidecarIndex() << " : " << std::boolalpha << GetWriteSidecarIndex() << std::endl;
 
         return tmp.str();
     };
@@ -105,6 +244,7 @@ public:
         bool file_open_failure;
         bool json_parse_error;
         std::vector<std::string> missing_keys;
+        std::vector<std::string> invalid_keys;
         std::string Dump() const
         {
             std::ostringstream tmp;
@@ -123,6 +263,16 @@ public:
                     }
                     tmp << "]" << std::endl;
                 }
+
+                if (invalid_keys.size() > 0)
+                {
+                    tmp << "    Invalid Values    : [ ";
+                    for (const auto &key : invalid_keys)
+                    {
+                        tmp << key << " ";
+                    }
+                    tmp << "]" << std::endl;
+                }
             }
             return tmp.str();
         };
@@ -139,8 +289,62 @@ private:
     std::string fNameOfRawEventsTable;     // "test.raw_events"
     std::string fNameOfPlanesTable;        // "test.planes"
     std::string fNameOfRawFilesTable;      // "test.raw_files"
+    MAIKo2Decoder::StreamRawDataEngine fStreamEngine = MAIKo2Decoder::StreamRawDataEngine::IFStream; // "ifstream"
+    ValidationLevel fValidationLevel = ValidationLevel::Full;                                        // "full"
+    unsigned int fNumberOfChunksPerFile = 1;                                                         // 1
+    unsigned int fNumberOfThreads = 0;                                                               // 0 (hardware concurrency)
+    unsigned int fNumberOfDBWriters = 1;                                                             // 1
+    std::size_t fRecordBatchSize = 10000;                                                            // 10000 records
+    std::size_t fRecordQueueSize = 16;                                                               // 16 batches
+    DBInsertMode fDBInsertMode = DBInsertMode::Insert;                                               // "insert"
+    std::size_t fDBInsertBatchSize = 500;                                                            // 500 rows in a statement
+    bool fIncremental = false;                                                                       // false
+    bool fFollow = false;                                                                            // false
+    double fFollowPollingInterval = 1.;                                                              // 1 s
+    double fFollowIdleTimeout = 60.;                                                                 // 60 s
+    bool fWriteSidecarIndex = false;                                                                 // false
     std::ostringstream fLog;
 
+    static std::string StreamEngineToString(MAIKo2Decoder::StreamRawDataEngine _engine)
+    {
+        switch (_engine)
+        {
+        case MAIKo2Decoder::StreamRawDataEngine::MemoryMap:
+            return "mmap";
+        case MAIKo2Decoder::StreamRawDataEngine::IFStream:
+        default:
+            return "ifstream";
+        }
+    }
+
+    static std::string DBInsertModeToString(DBInsertMode _mode)
+    {
+        switch (_mode)
+        {
+        case DBInsertMode::Insert:
+            return "insert";
+        case DBInsertMode::Prepared:
+            return "prepared";
+        case DBInsertMode::Copy:
+        default:
+            return "copy";
+        }
+    }
+
+    static std::string ValidationLevelToString(ValidationLevel _level)
+    {
+        switch (_level)
+        {
+        case ValidationLevel::Counters:
+            return "counters";
+        case ValidationLevel::Structure:
+            return "structure";
+        case ValidationLevel::Full:
+        default:
+            return "full";
+        }
+    }
+
     ReadJsonResultType ReadJsonFile(std::string _path)
     {
         std::ifstream f(_path);
@@ -201,10 +405,1001 @@ private:
         fNameOfRawEventsTable = data[KeyOfNameOfRawEventsTable()].get<std::string>();
         fNameOfPlanesTable = data[KeyOfNameOfPlanesTable()].get<std::string>();
         fNameOfRawFilesTable = data[KeyOfNameOfRawFilesTable()].get<std::string>();
-        return ReadJsonResultType();
+
+        // Optional keys
+        ReadJsonResultType result;
+        if (data.contains(KeyOfStreamEngine()))
+        {
+            auto engine = data[KeyOfStreamEngine()].get<std::string>();
+            if (engine == "ifstream")
+                fStreamEngine = MAIKo2Decoder::StreamRawDataEngine::IFStream;
+            else if (engine == "mmap")
+                fStreamEngine = MAIKo2Decoder::StreamRawDataEngine::MemoryMap;
+            else
+                result.invalid_keys.push_back(KeyOfStreamEngine());
+        }
+
+        if (data.contains(KeyOfValidationLevel()))
+        {
+            auto level = data[KeyOfValidationLevel()].get<std::string>();
+            if (level == "counters")
+                fValidationLevel = ValidationLevel::Counters;
+            else if (level == "structure")
+                fValidationLevel = ValidationLevel::Structure;
+            else if (level == "full")
+                fValidationLevel = ValidationLevel::Full;
+            else
+                result.invalid_keys.push_back(KeyOfValidationLevel());
+        }
+
+        if (data.contains(KeyOfNumberOfChunksPerFile()))
+        {
+            auto nChunks = data[KeyOfNumberOfChunksPerFile()].get<int>();
+            if (nChunks >= 1)
+                fNumberOfChunksPerFile = nChunks;
+            else
+                result.invalid_keys.push_back(KeyOfNumberOfChunksPerFile());
+        }
+
+        if (data.contains(KeyOfNumberOfThreads()))
+        {
+            auto nThreads = data[KeyOfNumberOfThreads()].get<int>();
+            if (nThreads >= 0)
+                fNumberOfThreads = nThreads;
+            else
+                result.invalid_keys.push_back(KeyOfNumberOfThreads());
+        }
+
+        if (data.contains(KeyOfNumberOfDBWriters()))
+        {
+            auto nWriters = data[KeyOfNumberOfDBWriters()].get<int>();
+            if (nWriters >= 1)
+                fNumberOfDBWriters = nWriters;
+            else
+                result.invalid_keys.push_back(KeyOfNumberOfDBWriters());
+        }
+
+        if (data.contains(KeyOfRecordBatchSize()))
+        {
+            auto batchSize = data[KeyOfRecordBatchSize()].get<int>();
+            if (batchSize >= 1)
+                fRecordBatchSize = batchSize;
+            else
+                result.invalid_keys.push_back(KeyOfRecordBatchSize());
+        }
+
+        if (data.contains(KeyOfRecordQueueSize()))
+        {
+            auto queueSize = data[KeyOfRecordQueueSize()].get<int>();
+            if (queueSize >= 1)
+                fRecordQueueSize = queueSize;
+            else
+                result.invalid_keys.push_back(KeyOfRecordQueueSize());
+        }
+
+        if (data.contains(KeyOfDBInsertMode()))
+        {
+            auto mode = data[KeyOfDBInsertMode()].get<std::string>();
+            if (mode == "insert")
+                fDBInsertMode = DBInsertMode::Insert;
+            else if (mode == "copy")
+                fDBInsertMode = DBInsertMode::Copy;
+            else if (mode == "prepared")
+                fDBInsertMode = DBInsertMode::Prepared;
+            else
+                result.invalid_keys.push_back(KeyOfDBInsertMode());
+        }
+
+        if (data.contains(KeyOfDBInsertBatchSize()))
+        {
+            auto batchSize = data[KeyOfDBInsertBatchSize()].get<int>();
+            if (batchSize >= 1 && batchSize <= (int)MaxRowsInPreparedStatement)
+                fDBInsertBatchSize = batchSize;
+            else
+                result.invalid_keys.push_back(KeyOfDBInsertBatchSize());
+        }
+
+        if (data.contains(KeyOfIncremental()))
+        {
+            if (data[KeyOfIncremental()].is_boolean())
+                fIncremental = data[KeyOfIncremental()].get<bool>();
+            else
+                result.invalid_keys.push_back(KeyOfIncremental());
+        }
+
+        if (data.contains(KeyOfFollow()))
+        {
+            if (data[KeyOfFollow()].is_boolean())
+                fFollow = data[KeyOfFollow()].get<bool>();
+            else
+                result.invalid_keys.push_back(KeyOfFollow());
+        }
+
+        if (data.contains(KeyOfFollowPollingInterval()))
+        {
+            auto interval = data[KeyOfFollowPollingInterval()].get<double>();
+            if (interval > 0.)
+                fFollowPollingInterval = interval;
+            else
+                result.invalid_keys.push_back(KeyOfFollowPollingInterval());
+        }
+
+        if (data.contains(KeyOfFollowIdleTimeout()))
+        {
+            auto timeout = data[KeyOfFollowIdleTimeout()].get<double>();
+            if (timeout > 0.)
+                fFollowIdleTimeout = timeout;
+            else
+                result.invalid_keys.push_back(KeyOfFollowIdleTimeout());
+        }
+
+        if (data.contains(KeyOfWriteSidecarIndex()))
+        {
+            if (data[KeyOfWriteSidecarIndex()].is_boolean())
+                fWriteSidecarIndex = data[KeyOfWriteSidecarIndex()].get<bool>();
+            else
+                result.invalid_keys.push_back(KeyOfWriteSidecarIndex());
+        }
+
+        if (result.invalid_keys.size() > 0)
+            result.good = false;
+        return result;
+    };
+};
+
+// Stream a raw data file (from _file.start_address) and push the records of its events to _queue in batches of record_batch_size records.
+// The sidecar index of the file is written, if requested, after the file is streamed.
+ResultsOfFile IndexRawFile(const RawFileToIndex &_file, const IndexOptions &_options,
+                           MAIKo2Decoder::BoundedQueue<RawEventsRecordBatch> &_queue)
+{
+    ResultsOfFile results;
+    const ValidationLevel validationLevel = _options.validation_level;
+    const unsigned int nChunksPerFile = _options.number_of_chunks_per_file;
+    const std::size_t batchSize = _options.record_batch_size;
+
+    MAIKo2Decoder::StreamRawDataInput inp;
+    inp.fileName = _file.file_path;
+    inp.engine = _options.stream_engine;
+    inp.start_address = _file.start_address;
+    inp.first_event_id = _file.first_event_id;
+    inp.growing = _file.growing;
+    results.file.run_id = _file.run_id;
+    results.file.plane_id = _file.plane_id;
+    results.file.board_id = _file.board_id;
+    results.file.file_number = _file.file_number;
+    results.file.file_path = _file.file_path;
+    results.file.file_size = _file.fingerprint.size;
+    results.file.file_mtime = _file.fingerprint.mtime;
+    results.file.file_fingerprint = static_cast<int64_t>(_file.fingerprint.fingerprint);
+
+    RawEventsRecordBatch batch;
+    batch.run_id = _file.run_id;
+    batch.plane_id = _file.plane_id;
+    batch.board_id = _file.board_id;
+    batch.file_number = _file.file_number;
+    std::vector<MAIKo2Decoder::RawEventsRecord> &recs = batch.records;
+
+    // Records of all events in the file for the sidecar index. Those before start_address are taken from the current index.
+    const std::string sidecarIndexPath = MAIKo2Decoder::GetSidecarIndexPath(_file.file_path);
+    bool writeSidecarIndex = _options.write_sidecar_index;
+    std::vector<MAIKo2Decoder::RawEventsRecord> sidecarRecords;
+    if (writeSidecarIndex && _file.start_address != 0)
+    {
+        MAIKo2Decoder::SidecarIndex sidecarIndex(sidecarIndexPath);
+        if (sidecarIndex.IsGood())
+            sidecarRecords = sidecarIndex.GetRecordsInEventOrder(_file.run_id, _file.plane_id, _file.board_id, _file.file_number);
+        // Events are indexed from 1 without a gap
+        if (!sidecarIndex.IsGood() || sidecarRecords.size() != _file.first_event_id - 1 ||
+            (!sidecarRecords.empty() && sidecarRecords.back().event_id != _file.first_event_id - 1))
+        {
+            std::cerr << "[Warning] : Sidecar index " << sidecarIndexPath << " does not match the events indexed. "
+                      << "It is not updated." << std::endl;
+            writeSidecarIndex = false;
+        }
+    }
+
+    // Push the records and begin the next batch
+    uint64_t nextEventId = _file.first_event_id;
+    auto flushRecords = [&batch, &_queue, &sidecarRecords, writeSidecarIndex, &nextEventId]()
+    {
+        if (!batch.records.empty())
+            nextEventId = batch.records.back().event_id + 1;
+        if (writeSidecarIndex)
+            sidecarRecords.insert(sidecarRecords.end(), batch.records.begin(), batch.records.end());
+        RawEventsRecordBatch next = batch;
+        next.records.clear();
+        _queue.Push(std::move(batch));
+        batch = std::move(next);
+    };
+
+    // Record template
+    MAIKo2Decoder::RawEventsRecord rec_temp;
+    rec_temp.run_id = _file.run_id;
+    rec_temp.plane_id = _file.plane_id;
+    rec_temp.board_id = _file.board_id;
+    rec_temp.file_number = _file.file_number;
+
+    // Check the event and fill its record in _rec. Return false if the event is rejected.
+    auto indexEvent = [rec_temp, validationLevel](const MAIKo2Decoder::RawEventData &evt,
+                                                  MAIKo2Decoder::RawEventsRecord &_rec)
+    {
+        MAIKo2Decoder::CounterData counter(evt.words.GetCounterWords());
+
+        // debug
+        // if (evt.event_id > 10)
+        //     return false;
+
+        if (!counter.IsGood())
+            return false;
+
+        if (validationLevel == ValidationLevel::Structure)
+        {
+            if (!MAIKo2Decoder::FADCData::CheckStructure(evt.words.GetFADCWords()) ||
+                !MAIKo2Decoder::TPCData::CheckStructure(evt.words.GetTPCWords()))
+            {
+                return false;
+            }
+        }
+        else if (validationLevel == ValidationLevel::Full)
+        {
+            MAIKo2Decoder::FADCData fadc(evt.words.GetFADCWords());
+            MAIKo2Decoder::TPCData tpc(evt.words.GetTPCWords());
+            if (!fadc.IsGood() ||
+                !tpc.IsGood())
+            {
+                return false;
+            }
+        }
+
+        _rec = rec_temp;
+        _rec.event_id = evt.event_id;
+        _rec.event_data_address = evt.event_data_address;
+        _rec.event_data_length = evt.event_data_length;
+        _rec.event_fadc_words_offset = evt.words.GetEventFADCWordsOffset();
+        _rec.event_tpc_words_offset = evt.words.GetEventTPCWordsOffset();
+        _rec.event_clock_counter = counter.GetClockCounter();
+        _rec.event_trigger_counter = counter.GetTriggerCounter();
+        return true;
+    };
+
+    MAIKo2Decoder::StreamRawDataResult resultOfStream;
+    if (nChunksPerFile > 1)
+    {
+        // Records are pushed in the order of the file. Those of the first chunk not done yet (headChunk) are pushed
+        // as they come, and those of a later chunk are held until all chunks before it are done.
+        // After a chunk stopped at a failure, the records of the later chunks are discarded as StreamRawData() does.
+        std::mutex mutexOfChunks; // for the variables below, recs and the queue
+        std::vector<std::vector<MAIKo2Decoder::RawEventsRecord>> recsOfChunks(nChunksPerFile);
+        std::vector<char> chunkDone(nChunksPerFile, false);
+        std::vector<char> chunkFailed(nChunksPerFile, false);
+        unsigned int headChunk = 0;
+        bool stopped = false;
+        auto pushRecord = [&recs, &flushRecords, batchSize](const MAIKo2Decoder::RawEventsRecord &_rec)
+        {
+            recs.push_back(_rec);
+            if (recs.size() >= batchSize)
+                flushRecords();
+        };
+        resultOfStream = MAIKo2Decoder::StreamRawDataInParallel(
+            inp, nChunksPerFile,
+            [&](unsigned int _iChunk, const MAIKo2Decoder::RawEventData &evt)
+            {
+                MAIKo2Decoder::RawEventsRecord rec;
+                if (!indexEvent(evt, rec))
+                    return false;
+                std::lock_guard<std::mutex> lock(mutexOfChunks);
+                if (_iChunk != headChunk)
+                    recsOfChunks[_iChunk].push_back(rec);
+                else if (!stopped)
+                    pushRecord(rec);
+                return true;
+            },
+            [&](unsigned int _iChunk, bool _failed)
+            {
+                std::lock_guard<std::mutex> lock(mutexOfChunks);
+                chunkDone[_iChunk] = true;
+                chunkFailed[_iChunk] = _failed;
+                while (headChunk < nChunksPerFile && chunkDone[headChunk])
+                {
+                    stopped = stopped || chunkFailed[headChunk];
+                    if (++headChunk == nChunksPerFile)
+                        break;
+                    if (!stopped)
+                    {
+                        for (const auto &rec : recsOfChunks[headChunk])
+                            pushRecord(rec);
+                    }
+                    std::vector<MAIKo2Decoder::RawEventsRecord>().swap(recsOfChunks[headChunk]);
+                }
+            });
+    }
+    else
+    {
+        std::function<bool(MAIKo2Decoder::RawEventData)> callBack = [&recs, &indexEvent, &flushRecords, batchSize](const MAIKo2Decoder::RawEventData &evt)
+        {
+            MAIKo2Decoder::RawEventsRecord rec;
+            if (!indexEvent(evt, rec))
+                return false;
+            recs.push_back(rec);
+            if (recs.size() >= batchSize)
+                flushRecords();
+            return true;
+        };
+        resultOfStream = StreamRawData(inp, callBack);
+    }
+    // Records of the former content after the events indexed are deleted with the last batch, which is committed by any writer :
+    // the other batches of the file, with smaller event_id, are not affected.
+    if (_file.rewritten)
+        batch.delete_events_from = recs.empty() ? nextEventId : recs.back().event_id + 1;
+    if (!recs.empty() || _file.rewritten)
+        flushRecords();
+
+    // Not if the file is lost or rewritten (IndexRawFileFromStartAddress() indexes it again)
+    if (writeSidecarIndex && !resultOfStream.fileNotFound && !resultOfStream.invalidHeader)
+    {
+        if (!MAIKo2Decoder::WriteSidecarIndex(sidecarIndexPath, sidecarRecords, _file.fingerprint.size))
+            std::cerr << "[Warning] : Sidecar index " << sidecarIndexPath << " can not be written." << std::endl;
+    }
+
+    // The event at the end of a growing file is not indexed yet. Record the part indexed, so that the next incremental run
+    // resumes from the event rather than skipping the file.
+    if (_file.growing)
+    {
+        auto fingerprintOfIndexedPart = MAIKo2Decoder::TakeFileFingerprint(_file.file_path, resultOfStream.number_of_bytes_processed);
+        results.file.file_size = resultOfStream.number_of_bytes_processed;
+        results.file.file_fingerprint = fingerprintOfIndexedPart.good ? static_cast<int64_t>(fingerprintOfIndexedPart.fingerprint) : 0;
+    }
+
+    results.stream_result = resultOfStream;
+    return results;
+}
+
+// Index _file from its start_address by IndexRawFile().
+// If the event there is lost, the file was rewritten rather than appended, so that it is indexed from the beginning
+// and the records stored beyond its events are deleted.
+ResultsOfFile IndexRawFileFromStartAddress(const RawFileToIndex &_file, const IndexOptions &_options,
+                                           MAIKo2Decoder::BoundedQueue<RawEventsRecordBatch> &_queue)
+{
+    auto results = IndexRawFile(_file, _options, _queue);
+    if (_file.start_address != 0 && results.stream_result.invalidHeader &&
+        results.stream_result.number_of_events_processed == 0)
+    {
+        RawFileToIndex wholeFile = _file;
+        wholeFile.start_address = 0;
+        wholeFile.first_event_id = 1;
+        wholeFile.rewritten = true;
+        results = IndexRawFile(wholeFile, _options, _queue);
+    }
+    return results;
+}
+
+// Delete the records of the events of a file from _fromEventId in the raw_events table named _table
+void DeleteEventRecords(pqxx::work &_tx, const std::string &_table,
+                        uint32_t _runId, uint32_t _planeId, uint32_t _boardId, uint32_t _fileNumber, uint64_t _fromEventId)
+{
+    std::ostringstream query;
+    query << "DELETE FROM " << _table << " "
+          << "WHERE run_id = " << _runId << " AND plane_id = " << _planeId << " "
+          << "AND board_id = " << _boardId << " AND file_number = " << _fileNumber << " "
+          << "AND event_id >= " << _fromEventId
+          << ";";
+    _tx.exec(query.str());
+}
+
+// Insert (or update) _records into the raw_events table named _table, one statement for each record
+void InsertEventRecordsOneByOne(pqxx::work &_tx, const std::string &_table,
+                                const std::vector<MAIKo2Decoder::RawEventsRecord> &_records)
+{
+    for (auto &rec : _records)
+    {
+        std::ostringstream query;
+        query << "INSERT INTO " << _table << " ("
+              << ColumnsOfRawEventsTable
+              << ") "
+              << "VALUES ("
+              << rec.run_id << ", " << rec.plane_id << ", " << rec.board_id << ", " << rec.file_number << ", " << rec.event_id << ", "
+              << rec.event_data_address << ", " << rec.event_data_length << ", "
+              << rec.event_fadc_words_offset << ", " << rec.event_tpc_words_offset << ", "
+              << rec.event_clock_counter << ", " << rec.event_trigger_counter
+              << ") "
+              << "ON CONFLICT (run_id, plane_id, board_id, file_number, event_id) "
+              << "DO UPDATE "
+              << "SET "
+              << "event_data_address = " << rec.event_data_address << ", "
+              << "event_data_length = " << rec.event_data_length << ", "
+              << "event_fadc_words_offset = " << rec.event_fadc_words_offset << ", "
+              << "event_tpc_words_offset = " << rec.event_tpc_words_offset << ", "
+              << "event_clock_counter = " << rec.event_clock_counter << ", "
+              << "event_trigger_counter = " << rec.event_trigger_counter
+              << ";"
+              << std::endl;
+        pqxx::result res(_tx.exec(query.str()));
+    }
+}
+
+// Insert (or update) _records into the raw_events table named _table,
+// streaming them with COPY into a temporary staging table and merging it with a single statement.
+void InsertEventRecordsByCopy(pqxx::work &_tx, const std::string &_table,
+                              const std::vector<MAIKo2Decoder::RawEventsRecord> &_records)
+{
+    const std::string staging = "raw_events_staging";
+    _tx.exec("CREATE TEMPORARY TABLE " + staging + " (LIKE " + _table + " INCLUDING DEFAULTS) ON COMMIT DROP;");
+    {
+        auto stream = pqxx::stream_to::raw_table(_tx, staging, ColumnsOfRawEventsTable);
+        for (auto &rec : _records)
+        {
+            stream.write_values(rec.run_id, rec.plane_id, rec.board_id, rec.file_number, rec.event_id,
+                                rec.event_data_address, rec.event_data_length,
+                                rec.event_fadc_words_offset, rec.event_tpc_words_offset,
+                                rec.event_clock_counter, rec.event_trigger_counter);
+        }
+        stream.complete();
+    }
+    std::ostringstream query;
+    query << "INSERT INTO " << _table << " (" << ColumnsOfRawEventsTable << ") "
+          << "SELECT " << ColumnsOfRawEventsTable << " FROM " << staging << " "
+          << "ON CONFLICT (run_id, plane_id, board_id, file_number, event_id) "
+          << "DO UPDATE "
+          << "SET "
+          << "event_data_address = EXCLUDED.event_data_address, "
+          << "event_data_length = EXCLUDED.event_data_length, "
+          << "event_fadc_words_offset = EXCLUDED.event_fadc_words_offset, "
+          << "event_tpc_words_offset = EXCLUDED.event_tpc_words_offset, "
+          << "event_clock_counter = EXCLUDED.event_clock_counter, "
+          << "event_trigger_counter = EXCLUDED.event_trigger_counter"
+          << ";";
+    _tx.exec(query.str());
+}
+
+// Insert (or update) _files into the raw_files table named _table, one statement for each record
+void InsertFileRecordsOneByOne(pqxx::work &_tx, const std::string &_table,
+                               const std::vector<MAIKo2Decoder::RawFilesRecord> &_files)
+{
+    for (auto &file : _files)
+    {
+        std::ostringstream query;
+        query << "INSERT INTO " << _table << " ("
+              << ColumnsOfRawFilesTable
+              << ") "
+              << "VALUES ("
+              << file.run_id << ", " << file.plane_id << ", " << file.board_id << ", " << file.file_number << ", "
+              << "'" << file.file_path << "', "
+              << file.file_size << ", " << file.file_mtime << ", " << file.file_fingerprint
+              << ") "
+              << "ON CONFLICT (run_id, plane_id, board_id, file_number) "
+              << "DO UPDATE "
+              << "SET "
+              << "file_path = "
+              << "'" << file.file_path << "', "
+              << "file_size = " << file.file_size << ", "
+              << "file_mtime = " << file.file_mtime << ", "
+              << "file_fingerprint = " << file.file_fingerprint
+              << ";"
+              << std::endl;
+        // std::cout << query.str() << std::endl;
+        pqxx::result res(_tx.exec(query.str()));
+    }
+}
+
+// Insert (or update) _files into the raw_files table named _table with COPY and a single merging statement
+void InsertFileRecordsByCopy(pqxx::work &_tx, const std::string &_table,
+                             const std::vector<MAIKo2Decoder::RawFilesRecord> &_files)
+{
+    const std::string staging = "raw_files_staging";
+    _tx.exec("CREATE TEMPORARY TABLE " + staging + " (LIKE " + _table + " INCLUDING DEFAULTS) ON COMMIT DROP;");
+    {
+        auto stream = pqxx::stream_to::raw_table(_tx, staging, ColumnsOfRawFilesTable);
+        for (auto &file : _files)
+            stream.write_values(file.run_id, file.plane_id, file.board_id, file.file_number, file.file_path,
+                                file.file_size, file.file_mtime, file.file_fingerprint);
+        stream.complete();
+    }
+    std::ostringstream query;
+    query << "INSERT INTO " << _table << " (" << ColumnsOfRawFilesTable << ") "
+          << "SELECT " << ColumnsOfRawFilesTable << " FROM " << staging << " "
+          << "ON CONFLICT (run_id, plane_id, board_id, file_number) "
+          << "DO UPDATE "
+          << "SET "
+          << "file_path = EXCLUDED.file_path, "
+          << "file_size = EXCLUDED.file_size, "
+          << "file_mtime = EXCLUDED.file_mtime, "
+          << "file_fingerprint = EXCLUDED.file_fingerprint"
+          << ";";
+    _tx.exec(query.str());
+}
+
+// Name of the prepared statement upserting _nRows records into the raw_events table
+std::string NameOfPreparedEventsUpsert(std::size_t _nRows)
+{
+    return "upsert_raw_events_" + std::to_string(_nRows);
+}
+
+// Numbers of rows of the prepared statements for batches of up to _batchSize records : _batchSize and the powers of 2 below it.
+// Any number of records is sent with at most 1 + log2(_batchSize) kinds of statements.
+std::vector<std::size_t> RowsOfPreparedEventsUpserts(std::size_t _batchSize)
+{
+    std::vector<std::size_t> rows{_batchSize};
+    for (std::size_t nRows = 1; nRows < _batchSize; nRows *= 2)
+        rows.push_back(nRows);
+    return rows;
+}
+
+// Prepare the statements upserting records into the raw_events table named _table on _connection
+void PrepareEventsUpserts(pqxx::connection &_connection, const std::string &_table, std::size_t _batchSize)
+{
+    for (auto nRows : RowsOfPreparedEventsUpserts(_batchSize))
+    {
+        std::ostringstream query;
+        query << "INSERT INTO " << _table << " (" << ColumnsOfRawEventsTable << ") "
+              << "VALUES ";
+        for (std::size_t iRow = 0; iRow < nRows; ++iRow)
+        {
+            query << (iRow == 0 ? "(" : ", (");
+            for (std::size_t iColumn = 0; iColumn < NumberOfColumnsOfRawEventsTable; ++iColumn)
+                query << (iColumn == 0 ? "$" : ", $") << iRow * NumberOfColumnsOfRawEventsTable + iColumn + 1;
+            query << ")";
+        }
+        query << " "
+              << "ON CONFLICT (run_id, plane_id, board_id, file_number, event_id) "
+              << "DO UPDATE "
+              << "SET "
+              << "event_data_address = EXCLUDED.event_data_address, "
+              << "event_data_length = EXCLUDED.event_data_length, "
+              << "event_fadc_words_offset = EXCLUDED.event_fadc_words_offset, "
+              << "event_tpc_words_offset = EXCLUDED.event_tpc_words_offset, "
+              << "event_clock_counter = EXCLUDED.event_clock_counter, "
+              << "event_trigger_counter = EXCLUDED.event_trigger_counter"
+              << ";";
+        _connection.prepare(NameOfPreparedEventsUpsert(nRows), query.str());
+    }
+}
+
+// Insert (or update) _records into the raw_events table with the statements prepared by PrepareEventsUpserts()
+void InsertEventRecordsPrepared(pqxx::work &_tx, const std::vector<MAIKo2Decoder::RawEventsRecord> &_records,
+                                std::size_t _batchSize)
+{
+    std::size_t iRecord = 0;
+    while (iRecord < _records.size())
+    {
+        // A full batch, or the largest power of 2 not exceeding the rest
+        std::size_t nRows = _batchSize;
+        if (_records.size() - iRecord < _batchSize)
+            for (nRows = 1; nRows * 2 <= _records.size() - iRecord; nRows *= 2)
+                ;
+
+        pqxx::params values;
+        values.reserve(nRows * NumberOfColumnsOfRawEventsTable);
+        for (std::size_t iRow = 0; iRow < nRows; ++iRow)
+        {
+            const auto &rec = _records[iRecord + iRow];
+            values.append(rec.run_id);
+            values.append(rec.plane_id);
+            values.append(rec.board_id);
+            values.append(rec.file_number);
+            values.append(rec.event_id);
+            values.append(rec.event_data_address);
+            values.append(rec.event_data_length);
+            values.append(rec.event_fadc_words_offset);
+            values.append(rec.event_tpc_words_offset);
+            values.append(rec.event_clock_counter);
+            values.append(rec.event_trigger_counter);
+        }
+        _tx.exec_prepared(NameOfPreparedEventsUpsert(nRows), values);
+        iRecord += nRows;
+    }
+}
+
+// Prepare the statement upserting a record into the raw_files table named _table on _connection
+void PrepareFilesUpsert(pqxx::connection &_connection, const std::string &_table)
+{
+    std::ostringstream query;
+    query << "INSERT INTO " << _table << " (" << ColumnsOfRawFilesTable << ") "
+          << "VALUES ($1, $2, $3, $4, $5, $6, $7, $8) "
+          << "ON CONFLICT (run_id, plane_id, board_id, file_number) "
+          << "DO UPDATE "
+          << "SET "
+          << "file_path = EXCLUDED.file_path, "
+          << "file_size = EXCLUDED.file_size, "
+          << "file_mtime = EXCLUDED.file_mtime, "
+          << "file_fingerprint = EXCLUDED.file_fingerprint"
+          << ";";
+    _connection.prepare("upsert_raw_files", query.str());
+}
+
+// Insert (or update) _files into the raw_files table with the statement prepared by PrepareFilesUpsert()
+void InsertFileRecordsPrepared(pqxx::work &_tx, const std::vector<MAIKo2Decoder::RawFilesRecord> &_files)
+{
+    for (auto &file : _files)
+        _tx.exec_prepared("upsert_raw_files", file.run_id, file.plane_id, file.board_id, file.file_number, file.file_path,
+                          file.file_size, file.file_mtime, file.file_fingerprint);
+}
+
+// (plane_id, board_id, file_number)
+using RawFileKey = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+// Number of records written to the DB and the time spent
+struct DBWriteStatistics
+{
+    uint64_t number_of_records = 0;
+    uint64_t number_of_failed_batches = 0;
+    std::set<RawFileKey> files_of_failed_batches;
+    double elapsed_seconds = 0.;
+};
+
+double RecordsPerSecond(const DBWriteStatistics &_statistics)
+{
+    return (_statistics.elapsed_seconds > 0.) ? _statistics.number_of_records / _statistics.elapsed_seconds : 0.;
+}
+
+// Insert (or update) the records in the batches from _queue to the raw_events table until the queue is closed.
+// Each batch is inserted in a transaction. A batch failed is reported and counted, and the next ones are still inserted.
+DBWriteStatistics WriteEventRecords(pqxx::connection &_connection, const std::string &_nameOfRawEventsTable,
+                                    DBInsertMode _insertMode, std::size_t _insertBatchSize,
+                                    MAIKo2Decoder::BoundedQueue<RawEventsRecordBatch> &_queue)
+{
+    // Statements are prepared with the 1st batch. If it fails, the batches are failed for the same reason.
+    bool prepared = (_insertMode != DBInsertMode::Prepared);
+    std::exception_ptr failureOfPrepare;
+    auto insertBatch = [&](RawEventsRecordBatch &_batch) -> std::size_t
+    {
+        if (failureOfPrepare)
+            std::rethrow_exception(failureOfPrepare);
+        if (!prepared)
+        {
+            try
+            {
+                PrepareEventsUpserts(_connection, _nameOfRawEventsTable, _insertBatchSize);
+                prepared = true;
+            }
+            catch (...)
+            {
+                failureOfPrepare = std::current_exception();
+                throw;
+            }
+        }
+
+        // In the order of the primary key for the locality in the B-tree index
+        if (!std::is_sorted(_batch.records.begin(), _batch.records.end(), MAIKo2Decoder::RawEventsRecord::ComparePrimaryKey))
+            std::sort(_batch.records.begin(), _batch.records.end(), MAIKo2Decoder::RawEventsRecord::ComparePrimaryKey);
+
+        pqxx::work tx{_connection};
+        if (!_batch.records.empty()) // Empty if the batch is only to delete
+        {
+            if (_insertMode == DBInsertMode::Copy)
+                InsertEventRecordsByCopy(tx, _nameOfRawEventsTable, _batch.records);
+            else if (_insertMode == DBInsertMode::Prepared)
+                InsertEventRecordsPrepared(tx, _batch.records, _insertBatchSize);
+            else
+                InsertEventRecordsOneByOne(tx, _nameOfRawEventsTable, _batch.records);
+        }
+        if (_batch.delete_events_from != 0)
+            DeleteEventRecords(tx, _nameOfRawEventsTable, _batch.run_id, _batch.plane_id, _batch.board_id, _batch.file_number,
+                               _batch.delete_events_from);
+
+        tx.commit();
+        return _batch.records.size();
+    };
+    DBWriteStatistics statistics;
+    auto reportFailure = [&statistics](const RawEventsRecordBatch &_batch, std::exception_ptr _exception)
+    {
+        statistics.files_of_failed_batches.insert(RawFileKey(_batch.plane_id, _batch.board_id, _batch.file_number));
+        std::ostringstream batchName;
+        batchName << "run " << _batch.run_id << ", plane " << _batch.plane_id << ", board " << _batch.board_id << ", file " << _batch.file_number << " ";
+        try
+        {
+            std::rethrow_exception(_exception);
+        }
+        catch (const pqxx::sql_error &_e)
+        {
+            std::cerr << "[Error] : SQL exception occurred while inserting event records for "
+                      << batchName.str() << "into raw_events." << std::endl;
+            std::cerr << _e.what() << std::endl;
+        }
+        catch (const pqxx::usage_error &_e)
+        {
+            std::cerr << "[Error] : Some libpqxx usage exception occurred while inserting event records for "
+                      << batchName.str() << "into raw_events." << std::endl;
+            std::cerr << _e.what() << std::endl;
+        }
+        catch (const std::exception &_e)
+        {
+            std::cerr << "[Error] : Some exception occurred while inserting event records for "
+                      << batchName.str() << "into raw_events." << std::endl;
+            std::cerr << _e.what() << std::endl;
+        }
+        catch (...)
+        {
+            std::cerr << "[Error] : Unknown exception occurred while inserting event records for "
+                      << batchName.str() << "into raw_events." << std::endl;
+        }
     };
+
+    auto batchStatistics = MAIKo2Decoder::WriteBatches(_queue, insertBatch, reportFailure);
+    statistics.number_of_records = batchStatistics.number_of_records;
+    statistics.number_of_failed_batches = batchStatistics.number_of_failed_batches;
+    statistics.elapsed_seconds = batchStatistics.elapsed_seconds;
+    return statistics;
+}
+
+// Records of the files of run _runId in the raw_files table named _table, with their size, mtime and fingerprint stored
+std::map<RawFileKey, MAIKo2Decoder::RawFilesRecord> ReadStoredFileRecords(pqxx::work &_tx, const std::string &_table, uint32_t _runId)
+{
+    std::ostringstream query;
+    query << "SELECT plane_id, board_id, file_number, file_path, file_size, file_mtime, file_fingerprint "
+          << "FROM " << _table << " "
+          << "WHERE run_id = " << _runId << " "
+          << "AND file_size IS NOT NULL AND file_mtime IS NOT NULL AND file_fingerprint IS NOT NULL"
+          << ";";
+    std::map<RawFileKey, MAIKo2Decoder::RawFilesRecord> files;
+    for (const auto &row : _tx.exec(query.str()))
+    {
+        MAIKo2Decoder::RawFilesRecord file;
+        file.run_id = _runId;
+        file.plane_id = row[0].as<uint32_t>();
+        file.board_id = row[1].as<uint32_t>();
+        file.file_number = row[2].as<uint32_t>();
+        file.file_path = row[3].as<std::string>();
+        file.file_size = row[4].as<uint64_t>();
+        file.file_mtime = row[5].as<int64_t>();
+        file.file_fingerprint = row[6].as<int64_t>();
+        files[RawFileKey(file.plane_id, file.board_id, file.file_number)] = file;
+    }
+    return files;
+}
+
+// Read the record of the last event of _file in the raw_events table named _table. Return false if no event is stored.
+bool ReadLastEventRecord(pqxx::work &_tx, const std::string &_table, const RawFileToIndex &_file,
+                         MAIKo2Decoder::RawEventsRecord &_record)
+{
+    std::ostringstream query;
+    query << "SELECT event_id, event_data_address, event_data_length "
+          << "FROM " << _table << " "
+          << "WHERE run_id = " << _file.run_id << " AND plane_id = " << _file.plane_id << " "
+          << "AND board_id = " << _file.board_id << " AND file_number = " << _file.file_number << " "
+          << "ORDER BY event_id DESC LIMIT 1"
+          << ";";
+    pqxx::result res(_tx.exec(query.str()));
+    if (res.empty())
+        return false;
+    _record.run_id = _file.run_id;
+    _record.plane_id = _file.plane_id;
+    _record.board_id = _file.board_id;
+    _record.file_number = _file.file_number;
+    _record.event_id = res[0][0].as<uint64_t>();
+    _record.event_data_address = res[0][1].as<uint64_t>();
+    _record.event_data_length = res[0][2].as<uint32_t>();
+    return true;
+}
+
+// How a raw data file is indexed in the incremental mode
+enum class IncrementalAction
+{
+    Skip, // Unchanged since it was indexed
+    Tail, // Grown since it was indexed : index the events after the last one indexed
+    Full  // Changed, or not indexed yet
 };
 
+// Compare _file with its record stored in the raw_files table (_stored may be nullptr)
+IncrementalAction DecideIncrementalAction(const RawFileToIndex &_file, const MAIKo2Decoder::RawFilesRecord *_stored)
+{
+    if (_stored == nullptr || !_file.fingerprint.good || _stored->file_path != _file.file_path)
+        return IncrementalAction::Full;
+
+    if (_stored->file_size == _file.fingerprint.size &&
+        _stored->file_mtime == _file.fingerprint.mtime &&
+        _stored->file_fingerprint == static_cast<int64_t>(_file.fingerprint.fingerprint))
+        return IncrementalAction::Skip;
+
+    // Appended only, if the first file_size bytes are the same as when it was indexed
+    if (_stored->file_size < _file.fingerprint.size)
+    {
+        auto fingerprintOfIndexedPart = MAIKo2Decoder::TakeFileFingerprint(_file.file_path, _stored->file_size);
+        if (fingerprintOfIndexedPart.good &&
+            _stored->file_fingerprint == static_cast<int64_t>(fingerprintOfIndexedPart.fingerprint))
+            return IncrementalAction::Tail;
+    }
+    return IncrementalAction::Full;
+}
+
+// Insert (or update) the file records of a board into the raw_files table named _table in a transaction
+void WriteFileRecords(pqxx::connection &_connection, const std::string &_table, DBInsertMode _insertMode,
+                      const ResultsOfBoard &_results, DBWriteStatistics &_statistics)
+{
+    auto timeBegin = std::chrono::steady_clock::now();
+    try
+    {
+        pqxx::work tx{_connection};
+        if (_insertMode == DBInsertMode::Copy)
+            InsertFileRecordsByCopy(tx, _table, _results.files);
+        else if (_insertMode == DBInsertMode::Prepared)
+            InsertFileRecordsPrepared(tx, _results.files);
+        else
+            InsertFileRecordsOneByOne(tx, _table, _results.files);
+
+        tx.commit();
+        _statistics.number_of_records += _results.files.size();
+    }
+    catch (const pqxx::sql_error &_e)
+    {
+        std::cerr << "[Error] : SQL exception occurred while inserting file records for "
+                  << "run " << _results.run_id << ", plane " << _results.plane_id << ", board " << _results.board_id << " "
+                  << "into raw_files." << std::endl;
+        std::cerr << _e.what() << std::endl;
+        ++_statistics.number_of_failed_batches;
+    }
+    catch (const pqxx::usage_error &_e)
+    {
+        std::cerr << "[Error] : Some libpqxx usage exception occurred while inserting file records for "
+                  << "run " << _results.run_id << ", plane " << _results.plane_id << ", board " << _results.board_id << " "
+                  << "into raw_files." << std::endl;
+        std::cerr << _e.what() << std::endl;
+        ++_statistics.number_of_failed_batches;
+    }
+    catch (const std::exception &_e)
+    {
+        std::cerr << "[Error] : Some exception occurred while inserting file records for "
+                  << "run " << _results.run_id << ", plane " << _results.plane_id << ", board " << _results.board_id << " "
+                  << "into raw_files." << std::endl;
+        std::cerr << _e.what() << std::endl;
+        ++_statistics.number_of_failed_batches;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeBegin;
+    _statistics.elapsed_seconds += elapsed.count();
+}
+
+// Record of a file written before the DB writers commit the events of the file (follow mode).
+// The fingerprint of a file indexed to the end is left 0 until they are committed, so that the next incremental run does not skip
+// the file if some events are lost. That of a growing file is of the part indexed, from which the next run resumes as the events
+// are taken from raw_events.
+MAIKo2Decoder::RawFilesRecord GetFileRecordBeforeCommit(const ResultsOfFile &_resultsOfFile)
+{
+    auto file = _resultsOfFile.file;
+    if (!_resultsOfFile.stream_result.input.growing)
+        file.file_fingerprint = 0;
+    return file;
+}
+
+// Add the results of a file indexed (again) to the results of its board
+void AddResultsOfFile(ResultsOfBoard &_resultsOfBoard, const ResultsOfFile &_resultsOfFile)
+{
+    _resultsOfBoard.stream_results.push_back(_resultsOfFile.stream_result);
+    for (auto &file : _resultsOfBoard.files)
+    {
+        if (file.file_number == _resultsOfFile.file.file_number)
+        {
+            file = _resultsOfFile.file;
+            return;
+        }
+    }
+    _resultsOfBoard.files.push_back(_resultsOfFile.file);
+}
+
+// The last file of a board followed in the follow mode
+struct FollowedFile
+{
+    RawFileToIndex file;       // start_address and first_event_id : where indexing resumes
+    uint64_t size_indexed = 0; // size of the file when it was indexed last
+    bool stopped = false;      // Indexing stopped at an event rejected. Nothing more is indexed until the next file.
+};
+
+// Resume the next indexing of _followed after the events indexed with _result
+void UpdateFollowedFile(FollowedFile &_followed, const MAIKo2Decoder::StreamRawDataResult &_result)
+{
+    _followed.size_indexed = _followed.file.fingerprint.size;
+    if (_result.goodFlag || _result.noEventFooter || _result.noEventFound)
+    {
+        _followed.file.start_address = _result.number_of_bytes_processed;
+        _followed.file.first_event_id = _result.input.first_event_id + _result.number_of_events_processed;
+    }
+    else
+    {
+        _followed.stopped = true;
+    }
+}
+
+// Follow the raw data files being written by the DAQ.
+// Events appended to the last file of each board are indexed every polling interval, and the next file is followed once it appears.
+// The event at the end of a file is indexed when the next event or file follows it.
+// When no event is added for the idle timeout, the run is regarded as finished and the events at the end of the files are indexed.
+// _pathOfFile gives the path of (plane_id, board_id, file_number). _results are indexed by plane_id * nBoard + board_id.
+void FollowRawFiles(const Configuration &_config, pqxx::connection &_connection,
+                    const std::function<std::string(uint32_t, uint32_t, uint32_t)> &_pathOfFile,
+                    std::vector<FollowedFile> &_followedFiles, MAIKo2Decoder::BoundedQueue<RawEventsRecordBatch> &_queue,
+                    std::vector<ResultsOfBoard> &_results, DBWriteStatistics &_fileStatistics)
+{
+    const IndexOptions indexOptions = _config.GetIndexOptions();
+    const std::chrono::duration<double> pollingInterval(_config.GetFollowPollingInterval());
+    const std::chrono::duration<double> idleTimeout(_config.GetFollowIdleTimeout());
+    std::cout << "Follow " << _followedFiles.size() << " boards every " << pollingInterval.count() << " s "
+              << "until no event is added for " << idleTimeout.count() << " s" << std::endl;
+
+    MAIKo2Decoder::WorkStealingPool pool(_config.GetNumberOfThreads());
+    auto timeLastEvent = std::chrono::steady_clock::now();
+    bool runFinished = false;
+    while (true)
+    {
+        // Index the files grown, and the files finished by the next file
+        std::vector<std::future<ResultsOfFile>> vResultsFuture(_followedFiles.size());
+        std::vector<bool> finished(_followedFiles.size());
+        for (std::size_t index = 0; index < _followedFiles.size(); ++index)
+        {
+            auto &followed = _followedFiles[index];
+            const RawFileToIndex &file = followed.file;
+            finished[index] = runFinished ||
+                              MAIKo2Decoder::TakeFileFingerprint(_pathOfFile(file.plane_id, file.board_id, file.file_number + 1)).good;
+            auto fingerprint = MAIKo2Decoder::TakeFileFingerprint(file.file_path);
+            if (followed.stopped || !fingerprint.good ||
+                (fingerprint.size == followed.size_indexed && !finished[index]))
+                continue;
+
+            followed.file.fingerprint = fingerprint;
+            followed.file.growing = !finished[index];
+            vResultsFuture[index] = pool.Submit(
+                [=, &_queue]()
+                { return IndexRawFileFromStartAddress(file, indexOptions, _queue); });
+        }
+
+        bool eventAdded = false;
+        bool fileAdded = false;
+        for (std::size_t index = 0; index < _followedFiles.size(); ++index)
+        {
+            auto &followed = _followedFiles[index];
+            if (vResultsFuture[index].valid())
+            {
+                auto resultsOfFile = vResultsFuture[index].get();
+                const auto &resultOfStream = resultsOfFile.stream_result;
+                if (resultOfStream.number_of_events_processed > 0)
+                {
+                    eventAdded = true;
+                    std::cout << "[Follow] " << followed.file.file_path << " : event "
+                              << resultOfStream.input.first_event_id << " -- "
+                              << resultOfStream.input.first_event_id + resultOfStream.number_of_events_processed - 1 << std::endl;
+                }
+                UpdateFollowedFile(followed, resultOfStream);
+                if (followed.stopped)
+                    std::cerr << "[Warning] : Indexing of " << followed.file.file_path << " stopped at event "
+                              << followed.file.first_event_id << std::endl;
+
+                // Record the file so that its events can be browsed
+                ResultsOfBoard resultsOfFollowedFile;
+                resultsOfFollowedFile.run_id = followed.file.run_id;
+                resultsOfFollowedFile.plane_id = followed.file.plane_id;
+                resultsOfFollowedFile.board_id = followed.file.board_id;
+                resultsOfFollowedFile.files.push_back(GetFileRecordBeforeCommit(resultsOfFile));
+                WriteFileRecords(_connection, _config.GetNameOfRawFilesTable(), _config.GetDBInsertMode(),
+                                 resultsOfFollowedFile, _fileStatistics);
+                AddResultsOfFile(_results[index], resultsOfFile);
+            }
+
+            if (finished[index] && !runFinished)
+            {
+                FollowedFile next;
+                next.file = followed.file;
+                next.file.file_number = followed.file.file_number + 1;
+                next.file.file_path = _pathOfFile(next.file.plane_id, next.file.board_id, next.file.file_number);
+                next.file.start_address = 0;
+                next.file.first_event_id = 1;
+                std::cout << "[Follow] " << next.file.file_path << " found" << std::endl;
+                followed = next;
+                fileAdded = true;
+            }
+        }
+
+        if (runFinished)
+            break;
+        if (eventAdded || fileAdded)
+            timeLastEvent = std::chrono::steady_clock::now();
+        else if (std::chrono::steady_clock::now() - timeLastEvent > idleTimeout)
+        {
+            std::cout << "[Follow] No event is added for " << idleTimeout.count() << " s. The run is regarded as finished." << std::endl;
+            runFinished = true; // Index the events at the end of the files
+            continue;
+        }
+        if (!fileAdded) // Catch up without waiting if files are added
+            std::this_thread::sleep_for(pollingInterval);
+    }
+}
+
 int main(int argc, char *argv[])
 {
 
@@ -226,6 +1421,10 @@ int main(int argc, char *argv[])
         return 1;
     }
     std::cout << config.Dump() << std::endl;
+    if (config.GetNumberOfChunksPerFileInUse() != config.GetNumberOfChunksPerFile())
+        std::cout << "[Warning] : " << config.KeyOfNumberOfChunksPerFile() << " is limited to "
+                  << config.GetNumberOfChunksPerFileInUse() << " by the number of hardware threads "
+                  << "shared by " << config.KeyOfNumberOfThreads() << " threads indexing files." << std::endl;
 
     // return 0;
 
@@ -235,8 +1434,17 @@ int main(int argc, char *argv[])
     // Check if the first (file_numer == 0) raw-data files for each boards exist
     const std::string dataDirectoryPath = config.GetDataDirectoryPath();
     const std::string rawDataFileFormat = config.GetRawDataFileFormat();
+    const IndexOptions indexOptions = config.GetIndexOptions();
     const unsigned int nPlane = 2;
     const unsigned int nBoard = 6;
+    auto pathOfFile = [&](uint32_t _planeId, uint32_t _boardId, uint32_t _fileNumber)
+    {
+        return dataDirectoryPath + "/" + MAIKo2Decoder::GenerateFileName(rawDataFileFormat,
+                                                                         run_id, 4,
+                                                                         _planeId, planeList,
+                                                                         _boardId, 1,
+                                                                         _fileNumber, 5);
+    };
 
     for (unsigned int iPlane = 0; iPlane < nPlane; ++iPlane)
     {
@@ -266,239 +1474,233 @@ int main(int argc, char *argv[])
         }
     }
 
-    // Stream files in parallel
-    const unsigned int nThread = nPlane * nBoard;
-    std::vector<std::future<ResultsOfThread>> vResultsFuture(nThread);
+    // Raw data files of each board in file_number order
+    std::vector<std::vector<RawFileToIndex>> filesOfBoards(nPlane * nBoard);
     for (unsigned int iPlane = 0; iPlane < nPlane; ++iPlane)
     {
         for (unsigned int iBoard = 0; iBoard < nBoard; ++iBoard)
         {
-            unsigned int index = iPlane * nBoard + iBoard;
-            vResultsFuture[index] = std::async(
-                std::launch::async,
-                [=](unsigned int _run_id, unsigned int _iPlane, unsigned int _iBoard)
-                    -> ResultsOfThread
-                {
-                    unsigned int file_number = 0;
+            for (unsigned int file_number = 0;; ++file_number)
+            {
+                std::string fileName = MAIKo2Decoder::GenerateFileName(rawDataFileFormat,
+                                                                       run_id, 4,
+                                                                       iPlane, planeList,
+                                                                       iBoard, 1,
+                                                                       file_number, 5);
+                std::string filePath = dataDirectoryPath + "/" + fileName;
+                auto fingerprint = MAIKo2Decoder::TakeFileFingerprint(filePath);
+                if (!fingerprint.good)
+                    break;
 
-                    ResultsOfThread resultsOfThread;
-                    resultsOfThread.run_id = _run_id;
-                    resultsOfThread.plane_id = _iPlane;
-                    resultsOfThread.board_id = _iBoard;
-                    while (true)
-                    {
-                        std::string fileName = MAIKo2Decoder::GenerateFileName(rawDataFileFormat,
-                                                                               run_id, 4,
-                                                                               iPlane, planeList,
-                                                                               iBoard, 1,
-                                                                               file_number, 5);
-
-                        std::string filePath = dataDirectoryPath + "/" + fileName;
-
-                        {
-                            std::ifstream tmp(filePath);
-                            if (!tmp.good())
-                                break;
-                        }
-
-                        MAIKo2Decoder::StreamRawDataInput inp;
-                        inp.fileName = filePath;
-                        MAIKo2Decoder::RawFilesRecord rec_files;
-                        rec_files.run_id = _run_id;
-                        rec_files.plane_id = _iPlane;
-                        rec_files.board_id = iBoard;
-                        rec_files.file_number = file_number;
-                        rec_files.file_path = filePath;
-
-                        std::vector<MAIKo2Decoder::RawEventsRecord> recs;
-                        // Record template
-                        MAIKo2Decoder::RawEventsRecord rec_temp;
-                        rec_temp.run_id = _run_id;
-                        rec_temp.plane_id = _iPlane;
-                        rec_temp.board_id = iBoard;
-                        rec_temp.file_number = file_number;
-
-                        std::function<bool(MAIKo2Decoder::RawEventData)> callBack = [&recs, rec_temp](const MAIKo2Decoder::RawEventData &evt)
-                        {
-                            MAIKo2Decoder::CounterData counter(evt.words.GetCounterWords());
-                            MAIKo2Decoder::FADCData fadc(evt.words.GetFADCWords());
-                            MAIKo2Decoder::TPCData tpc(evt.words.GetTPCWords());
-
-                            // debug
-                            // if (evt.event_id > 10)
-                            //     return false;
-
-                            if (!counter.IsGood() ||
-                                !fadc.IsGood() ||
-                                !tpc.IsGood())
-                            {
-                                return false;
-                            }
-
-                            MAIKo2Decoder::RawEventsRecord rec = rec_temp;
-                            rec.event_id = evt.event_id;
-                            rec.event_data_address = evt.event_data_address;
-                            rec.event_data_length = evt.event_data_length;
-                            rec.event_fadc_words_offset = evt.words.GetEventFADCWordsOffset();
-                            rec.event_tpc_words_offset = evt.words.GetEventTPCWordsOffset();
-                            rec.event_clock_counter = counter.GetClockCounter();
-                            rec.event_trigger_counter = counter.GetTriggerCounter();
-                            recs.push_back(rec);
-                            return true;
-                        };
-
-                        auto resultOfStream = StreamRawData(inp, callBack);
-
-                        resultsOfThread.stream_results.push_back(resultOfStream);
-                        std::copy(recs.begin(), recs.end(), std::back_inserter(resultsOfThread.records));
-                        resultsOfThread.files.push_back(rec_files);
-                        ++file_number;
-                    }
-                    return resultsOfThread;
-                },
-                run_id, iPlane, iBoard);
+                RawFileToIndex file;
+                file.run_id = run_id;
+                file.plane_id = iPlane;
+                file.board_id = iBoard;
+                file.file_number = file_number;
+                file.file_path = filePath;
+                file.fingerprint = fingerprint;
+                filesOfBoards[iPlane * nBoard + iBoard].push_back(file);
+            }
+            // The DAQ may be writing the last file
+            if (config.GetFollow())
+                filesOfBoards[iPlane * nBoard + iBoard].back().growing = true;
         }
     }
 
-    // Wait for end of stream and get result
-    std::vector<ResultsOfThread> vResults;
-    std::for_each(vResultsFuture.begin(), vResultsFuture.end(),
-                  [&](auto &_result)
-                  { vResults.push_back(_result.get()); });
-
-    // Check result
-    std::for_each(vResults.begin(), vResults.end(),
-                  [](ResultsOfThread &_resultsThread)
-                  {
-                      std::vector<std::string> fileNames;
-
-                      std::for_each(_resultsThread.stream_results.begin(),
-                                    _resultsThread.stream_results.end(),
-                                    [&](MAIKo2Decoder::StreamRawDataResult &_resultStream)
-                                    {
-                                        fileNames.push_back(_resultStream.input.fileName);
-                                        std::cout << _resultStream.input.fileName << std::endl;
-                                        std::cout << "Good   : " << _resultStream.goodFlag << std::endl;
-                                        std::cout << "Events : " << _resultStream.number_of_events_processed << std::endl;
-                                    });
-                  });
-
-    // Connect to db
+    // Connect to db : one connection for each DB writer and one for the file records
     pqxx::connection c(config.GetOptionsForConnectionToDB());
     std::cout << "Connected to " << c.dbname() << '\n';
+    std::vector<std::unique_ptr<pqxx::connection>> writerConnections;
+    for (unsigned int iWriter = 0; iWriter < config.GetNumberOfDBWriters(); ++iWriter)
+        writerConnections.push_back(std::make_unique<pqxx::connection>(config.GetOptionsForConnectionToDB()));
+    const DBInsertMode dbInsertMode = config.GetDBInsertMode();
+    if (dbInsertMode == DBInsertMode::Prepared)
+        PrepareFilesUpsert(c, config.GetNameOfRawFilesTable());
 
-    // Insert (or update) result to the raw_files table in DB
-    for (auto &result : vResults)
+    // Incremental mode : files unchanged since they were indexed are skipped,
+    // and only the events appended to grown files are indexed.
+    std::vector<const RawFileToIndex *> filesToIndex;
+    unsigned int nFilesSkipped = 0;
+    unsigned int nFilesResumed = 0;
     {
+        std::map<RawFileKey, MAIKo2Decoder::RawFilesRecord> storedFiles;
         pqxx::work tx{c};
-        try
+        if (config.GetIncremental())
+            storedFiles = ReadStoredFileRecords(tx, config.GetNameOfRawFilesTable(), run_id);
+        for (auto &files : filesOfBoards)
         {
-            for (auto &file : result.files)
+            for (auto &file : files)
             {
-                std::ostringstream query;
-                query << "INSERT INTO " << config.GetNameOfRawFilesTable() << " ("
-                      << "run_id, plane_id, board_id, file_number, "
-                      << "file_path"
-                      << ") "
-                      << "VALUES ("
-                      << file.run_id << ", " << file.plane_id << ", " << file.board_id << ", " << file.file_number << ", "
-                      << "'" << file.file_path << "'"
-                      << ") "
-                      << "ON CONFLICT (run_id, plane_id, board_id, file_number) "
-                      << "DO UPDATE "
-                      << "SET "
-                      << "file_path = "
-                      << "'" << file.file_path << "'"
-                      << ";"
-                      << std::endl;
-                // std::cout << query.str() << std::endl;
-                pqxx::result res(tx.exec(query.str()));
+                auto itStored = storedFiles.find(RawFileKey(file.plane_id, file.board_id, file.file_number));
+                auto action = DecideIncrementalAction(file, (itStored != storedFiles.end()) ? &itStored->second : nullptr);
+                if (action == IncrementalAction::Skip && file.growing) // To be followed from its last event
+                    action = IncrementalAction::Tail;
+                if (action != IncrementalAction::Full && config.GetWriteSidecarIndex() &&
+                    !MAIKo2Decoder::SidecarIndex(MAIKo2Decoder::GetSidecarIndexPath(file.file_path)).IsGood())
+                    action = IncrementalAction::Full; // To write its sidecar index
+                if (action == IncrementalAction::Skip)
+                {
+                    ++nFilesSkipped;
+                    continue;
+                }
+                // Changed since it was indexed : the records of the former content beyond the events indexed now are deleted
+                // with the last batch of the file. Without a stored record, the records are only upserted.
+                if (action == IncrementalAction::Full && itStored != storedFiles.end())
+                    file.rewritten = true;
+                MAIKo2Decoder::RawEventsRecord lastEvent;
+                if (action == IncrementalAction::Tail &&
+                    ReadLastEventRecord(tx, config.GetNameOfRawEventsTable(), file, lastEvent))
+                {
+                    file.start_address = lastEvent.event_data_address + lastEvent.event_data_length;
+                    file.first_event_id = lastEvent.event_id + 1;
+                    ++nFilesResumed;
+                }
+                filesToIndex.push_back(&file);
             }
+        }
+        tx.commit();
+    }
+    if (config.GetIncremental())
+        std::cout << "Incremental : " << nFilesSkipped << " files unchanged (skipped), "
+                  << nFilesResumed << " files grown (only the tail indexed)" << std::endl;
 
-            tx.commit();
+    // Index each file as a task in the pool. Larger files first, so that the tasks left at the end are short.
+    std::stable_sort(filesToIndex.begin(), filesToIndex.end(),
+                     [](const RawFileToIndex *_lhs, const RawFileToIndex *_rhs)
+                     { return _lhs->GetNumberOfBytesToIndex() > _rhs->GetNumberOfBytesToIndex(); });
+
+    // Records of events flow from the scanners to the DB writers through the queue, so that the DB is filled while scanning.
+    // Scanners wait while the queue is full, so that at most (recordQueueSize x recordBatchSize) records are in memory.
+    MAIKo2Decoder::BoundedQueue<RawEventsRecordBatch> recordQueue(config.GetRecordQueueSize());
+    const std::string nameOfRawEventsTable = config.GetNameOfRawEventsTable();
+    std::vector<std::future<DBWriteStatistics>> vWritersFuture;
+    for (auto &writerConnection : writerConnections)
+    {
+        vWritersFuture.push_back(std::async(std::launch::async, WriteEventRecords,
+                                            std::ref(*writerConnection), nameOfRawEventsTable,
+                                            dbInsertMode, config.GetDBInsertBatchSize(), std::ref(recordQueue)));
+    }
+
+    std::vector<ResultsOfBoard> vResults;
+    {
+        MAIKo2Decoder::WorkStealingPool pool(config.GetNumberOfThreads());
+        std::cout << "Index " << filesToIndex.size() << " files with " << pool.GetNumberOfThreads() << " threads" << std::endl;
+
+        std::vector<std::vector<std::future<ResultsOfFile>>> vResultsFuture(filesOfBoards.size());
+        for (unsigned int index = 0; index < filesOfBoards.size(); ++index)
+            vResultsFuture[index].resize(filesOfBoards[index].size());
+        for (const RawFileToIndex *file : filesToIndex)
+        {
+            vResultsFuture[file->plane_id * nBoard + file->board_id][file->file_number] = pool.Submit(
+                [=, &recordQueue]()
+                { return IndexRawFileFromStartAddress(*file, indexOptions, recordQueue); });
         }
-        catch (const pqxx::sql_error &_e)
+
+        // Wait for end of stream and get result of each board in file_number order
+        for (unsigned int iPlane = 0; iPlane < nPlane; ++iPlane)
         {
-            std::cerr << "[Error] : SQL exception occurred while inserting file records for "
-                      << "run " << result.run_id << ", plane " << result.plane_id << ", board " << result.board_id << " "
-                      << "into raw_files." << std::endl;
-            std::cerr << _e.what() << std::endl;
+            for (unsigned int iBoard = 0; iBoard < nBoard; ++iBoard)
+            {
+                ResultsOfBoard resultsOfBoard;
+                resultsOfBoard.run_id = run_id;
+                resultsOfBoard.plane_id = iPlane;
+                resultsOfBoard.board_id = iBoard;
+                for (auto &resultFuture : vResultsFuture[iPlane * nBoard + iBoard])
+                {
+                    if (!resultFuture.valid()) // Skipped
+                        continue;
+                    auto resultsOfFile = resultFuture.get();
+                    resultsOfBoard.stream_results.push_back(resultsOfFile.stream_result);
+                    resultsOfBoard.files.push_back(resultsOfFile.file);
+                }
+                vResults.push_back(std::move(resultsOfBoard));
+            }
         }
-        catch (const pqxx::usage_error &_e)
+        std::cout << "Tasks stolen : " << pool.GetNumberOfSteals() << std::endl;
+    }
+
+    DBWriteStatistics fileStatistics;
+    if (config.GetFollow())
+    {
+        // Record the files indexed so far, so that their events can be browsed during the run
+        for (auto &result : vResults)
         {
-            std::cerr << "[Error] : Some libpqxx usage exception occurred while inserting file records for "
-                      << "run " << result.run_id << ", plane " << result.plane_id << ", board " << result.board_id << " "
-                      << "into raw_files." << std::endl;
-            std::cerr << _e.what() << std::endl;
+            ResultsOfBoard resultsBeforeCommit = result;
+            for (std::size_t iFile = 0; iFile < result.files.size(); ++iFile)
+                resultsBeforeCommit.files[iFile] = GetFileRecordBeforeCommit(ResultsOfFile{result.stream_results[iFile], result.files[iFile]});
+            WriteFileRecords(c, config.GetNameOfRawFilesTable(), dbInsertMode, resultsBeforeCommit, fileStatistics);
         }
-        catch (const std::exception &_e)
+
+        // Resume from the last file of each board, which is never skipped in the follow mode
+        std::vector<FollowedFile> followedFiles;
+        for (unsigned int index = 0; index < filesOfBoards.size(); ++index)
         {
-            std::cerr << "[Error] : Some exception occurred while inserting file records for "
-                      << "run " << result.run_id << ", plane " << result.plane_id << ", board " << result.board_id << " "
-                      << "into raw_files." << std::endl;
-            std::cerr << _e.what() << std::endl;
+            FollowedFile followed;
+            followed.file = filesOfBoards[index].back();
+            UpdateFollowedFile(followed, vResults[index].stream_results.back());
+            followedFiles.push_back(followed);
         }
+        FollowRawFiles(config, c, pathOfFile, followedFiles, recordQueue, vResults, fileStatistics);
     }
 
-    // Insert (or update) result to the raw_events table in DB
-    for (auto &result : vResults)
+    // Wait for the DB writers to drain the queue
+    recordQueue.Close();
+    uint64_t nFailedBatches = 0;
+    std::set<RawFileKey> filesOfFailedBatches;
+    for (unsigned int iWriter = 0; iWriter < vWritersFuture.size(); ++iWriter)
     {
-        pqxx::work tx{c};
-        try
+        auto statistics = vWritersFuture[iWriter].get();
+        std::cout << "DB writer " << iWriter << " : " << statistics.number_of_records << " event records inserted in "
+                  << statistics.elapsed_seconds << " s (" << RecordsPerSecond(statistics) << " records/s)" << std::endl;
+        nFailedBatches += statistics.number_of_failed_batches;
+        filesOfFailedBatches.insert(statistics.files_of_failed_batches.begin(), statistics.files_of_failed_batches.end());
+    }
+    if (nFailedBatches > 0)
+    {
+        // Some events of these files may be missing in the DB. Do not let the next incremental run skip them.
+        std::cerr << "[Warning] : " << nFailedBatches << " batches of event records of " << filesOfFailedBatches.size() << " files failed. "
+                  << "The files will be indexed again in the incremental mode." << std::endl;
+        for (auto &result : vResults)
         {
-            for (auto &rec : result.records)
+            for (auto &file : result.files)
             {
-                std::ostringstream query;
-                query << "INSERT INTO " << config.GetNameOfRawEventsTable() << " ("
-                      << "run_id, plane_id, board_id, file_number, event_id, "
-                      << "event_data_address, event_data_length, "
-                      << "event_fadc_words_offset, event_tpc_words_offset, "
-                      << "event_clock_counter, event_trigger_counter"
-                      << ") "
-                      << "VALUES ("
-                      << rec.run_id << ", " << rec.plane_id << ", " << rec.board_id << ", " << rec.file_number << ", " << rec.event_id << ", "
-                      << rec.event_data_address << ", " << rec.event_data_length << ", "
-                      << rec.event_fadc_words_offset << ", " << rec.event_tpc_words_offset << ", "
-                      << rec.event_clock_counter << ", " << rec.event_trigger_counter
-                      << ") "
-                      << "ON CONFLICT (run_id, plane_id, board_id, file_number, event_id) "
-                      << "DO UPDATE "
-                      << "SET "
-                      << "event_data_address = " << rec.event_data_address << ", "
-                      << "event_data_length = " << rec.event_data_length << ", "
-                      << "event_fadc_words_offset = " << rec.event_fadc_words_offset << ", "
-                      << "event_tpc_words_offset = " << rec.event_tpc_words_offset << ", "
-                      << "event_clock_counter = " << rec.event_clock_counter << ", "
-                      << "event_trigger_counter = " << rec.event_trigger_counter
-                      << ";"
-                      << std::endl;
-                pqxx::result res(tx.exec(query.str()));
+                if (filesOfFailedBatches.count(RawFileKey(file.plane_id, file.board_id, file.file_number)) == 0)
+                    continue;
+                file.file_size = 0;
+                file.file_mtime = 0;
+                file.file_fingerprint = 0;
             }
-
-            tx.commit();
-        }
-        catch (const pqxx::sql_error &_e)
-        {
-            std::cerr << "[Error] : SQL exception occurred while inserting event records for "
-                      << "run " << result.run_id << ", plane " << result.plane_id << ", board " << result.board_id << " "
-                      << "into raw_events." << std::endl;
-            std::cerr << _e.what() << std::endl;
-        }
-        catch (const pqxx::usage_error &_e)
-        {
-            std::cerr << "[Error] : Some libpqxx usage exception occurred while inserting event records for "
-                      << "run " << result.run_id << ", plane " << result.plane_id << ", board " << result.board_id << " "
-                      << "into raw_events." << std::endl;
-            std::cerr << _e.what() << std::endl;
-        }
-        catch (const std::exception &_e)
-        {
-            std::cerr << "[Error] : Some exception occurred while inserting event records for "
-                      << "run " << result.run_id << ", plane " << result.plane_id << ", board " << result.board_id << " "
-                      << "into raw_events." << std::endl;
-            std::cerr << _e.what() << std::endl;
         }
     }
 
+    // Check result
+    std::for_each(vResults.begin(), vResults.end(),
+                  [](ResultsOfBoard &_resultsBoard)
+                  {
+                      std::vector<std::string> fileNames;
+
+                      std::for_each(_resultsBoard.stream_results.begin(),
+                                    _resultsBoard.stream_results.end(),
+                                    [&](MAIKo2Decoder::StreamRawDataResult &_resultStream)
+                                    {
+                                        fileNames.push_back(_resultStream.input.fileName);
+                                        std::cout << _resultStream.input.fileName << std::endl;
+                                        std::cout << "Good   : " << _resultStream.goodFlag << std::endl;
+                                        if (_resultStream.input.start_address != 0)
+                                            std::cout << "Resumed: from event " << _resultStream.input.first_event_id
+                                                      << " at " << _resultStream.input.start_address << " bytes" << std::endl;
+                                        std::cout << "Events : " << _resultStream.number_of_events_processed << std::endl;
+                                        std::cout << "Speed  : " << _resultStream.bytes_per_second / 1.e6 << " MB/s "
+                                                  << "(" << _resultStream.number_of_bytes_processed << " bytes in "
+                                                  << _resultStream.elapsed_seconds << " s)" << std::endl;
+                                    });
+                  });
+
+    // Insert (or update) result to the raw_files table in DB
+    for (auto &result : vResults)
+        WriteFileRecords(c, config.GetNameOfRawFilesTable(), dbInsertMode, result, fileStatistics);
+    std::cout << "File records inserted : " << fileStatistics.number_of_records << " in "
+              << fileStatistics.elapsed_seconds << " s (" << RecordsPerSecond(fileStatistics) << " records/s)" << std::endl;
+
     return 0;
 }
\ No newline at end of file
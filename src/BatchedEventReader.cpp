@@ -0,0 +1,129 @@
+#include "BatchedEventReader.hpp"
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "DecoderUtility.hpp"
+
+namespace MAIKo2Decoder
+{
+    // Read _nBytes from _address. Return false if not all of them are read.
+    static bool ReadFileBytes(int _fd, char *_buffer, std::size_t _nBytes, uint64_t _address)
+    {
+        std::size_t nRead = 0;
+        while (nRead < _nBytes)
+        {
+            auto n = pread(_fd, _buffer + nRead, _nBytes - nRead, _address + nRead);
+            if (n <= 0)
+                return false;
+            nRead += n;
+        }
+        return true;
+    }
+
+    std::vector<FetchedEvent> BatchedEventReader::Read(const std::vector<FragmentLocation> &_locations)
+    {
+        fStatistics = BatchedReadStatistics();
+        fStatistics.number_of_fragments = _locations.size();
+
+        // Fragments of each file in the order of the address
+        std::map<std::string, std::vector<const FragmentLocation *>> locationsOfFiles;
+        for (const auto &loc : _locations)
+            locationsOfFiles[loc.file_path].push_back(&loc);
+        fStatistics.number_of_files = locationsOfFiles.size();
+
+        std::map<uint32_t, FetchedEvent> events;
+        auto addFragment = [&events](const FragmentLocation &_loc, EventWordsBuffer _words, bool _good)
+        {
+            auto &evt = events[_loc.event_trigger_counter];
+            evt.trigger_counter = _loc.event_trigger_counter;
+            if (_good)
+                evt.fragments.push_back(StoredFragment{_loc.plane_id, _loc.board_id, std::move(_words)});
+            else
+                evt.good = false;
+        };
+
+        std::vector<char> buffer;
+        for (auto &item : locationsOfFiles)
+        {
+            auto &locs = item.second;
+            std::sort(locs.begin(), locs.end(),
+                      [](const FragmentLocation *_lhs, const FragmentLocation *_rhs)
+                      { return _lhs->event_data_address < _rhs->event_data_address; });
+
+            int fd = open(item.first.c_str(), O_RDONLY);
+            std::size_t iBegin = 0;
+            while (iBegin < locs.size())
+            {
+                // Merge the following fragments within the gap into a read of [begin, end)
+                const uint64_t begin = locs[iBegin]->event_data_address;
+                uint64_t end = begin + locs[iBegin]->event_data_length;
+                std::size_t iEnd = iBegin + 1;
+                for (; iEnd < locs.size(); ++iEnd)
+                {
+                    const uint64_t nextEnd = std::max(end, locs[iEnd]->event_data_address + locs[iEnd]->event_data_length);
+                    if (locs[iEnd]->event_data_address > end + fMaxGapBytes || nextEnd - begin > fMaxReadBytes)
+                        break;
+                    end = nextEnd;
+                }
+
+                buffer.resize(end - begin);
+                const bool good = (fd >= 0) && ReadFileBytes(fd, buffer.data(), buffer.size(), begin);
+                ++fStatistics.number_of_reads;
+                if (good)
+                    fStatistics.number_of_bytes_read += buffer.size();
+
+                for (std::size_t i = iBegin; i < iEnd; ++i)
+                {
+                    const auto &loc = *locs[i];
+                    if (!good || loc.event_data_length % sizeof(WordType) != 0)
+                    {
+                        ++fStatistics.number_of_failed_fragments;
+                        addFragment(loc, EventWordsBuffer(), false);
+                        continue;
+                    }
+                    std::vector<WordType> words(loc.event_data_length / sizeof(WordType));
+                    CorrectRawWords(reinterpret_cast<const WordType *>(buffer.data() + (loc.event_data_address - begin)),
+                                    words.data(), words.size());
+                    EventWordsBuffer buf = (loc.event_fadc_words_offset == 0 && loc.event_tpc_words_offset == 0)
+                                               ? EventWordsBuffer(std::move(words))
+                                               : EventWordsBuffer(std::move(words), loc.event_fadc_words_offset, loc.event_tpc_words_offset);
+                    const bool valid = buf.IsValid();
+                    if (!valid)
+                        ++fStatistics.number_of_failed_fragments;
+                    addFragment(loc, std::move(buf), valid);
+                }
+                iBegin = iEnd;
+            }
+            if (fd >= 0)
+                close(fd);
+        }
+
+        std::vector<FetchedEvent> result;
+        result.reserve(events.size());
+        for (auto &item : events)
+        {
+            auto &frgs = item.second.fragments;
+            std::sort(frgs.begin(), frgs.end(),
+                      [](const StoredFragment &_lhs, const StoredFragment &_rhs)
+                      { return std::tie(_lhs.plane_id, _lhs.board_id) < std::tie(_rhs.plane_id, _rhs.board_id); });
+            result.push_back(std::move(item.second));
+        }
+        return result;
+    }
+
+    bool BatchedEventReader::BuildEvent(uint32_t _run_id, const FetchedEvent &_fetched, BuiltEventStore &_event,
+                                        WorkStealingPool *_pool)
+    {
+        bool good = _fetched.good;
+        std::vector<FragmentTiming> timings;
+        for (auto &frg : DecodeFragments(_run_id, _fetched.trigger_counter, _fetched.fragments, _pool, timings))
+        {
+            if (!_event.AddFragment(std::move(frg)).good)
+                good = false;
+        }
+        return good;
+    }
+}
\ No newline at end of file
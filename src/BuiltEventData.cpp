@@ -0,0 +1,189 @@
+#include "BuiltEventData.hpp"
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+namespace MAIKo2Decoder
+{
+
+    FragmentedEventData DecodeFragment(uint32_t _run_id, uint32_t _plane_id, uint32_t _board_id, uint32_t _event_number,
+                                       const EventWordsBuffer &_words)
+    {
+        FragmentedEventData frg;
+        frg.run_id = _run_id;
+        frg.plane_id = _plane_id;
+        frg.board_id = _board_id;
+        frg.event_number = _event_number;
+        frg.counter = CounterData(_words.GetCounterWords());
+        frg.fadc = FADCData(_words.GetFADCWords());
+        frg.tpc = TPCData(_words.GetTPCWords());
+        return frg;
+    }
+
+    std::vector<FragmentedEventData> DecodeFragments(uint32_t _run_id, uint32_t _event_number,
+                                                     const std::vector<StoredFragment> &_fragments,
+                                                     WorkStealingPool *_pool, std::vector<FragmentTiming> &_timings)
+    {
+        std::vector<FragmentedEventData> decoded(_fragments.size());
+        _timings.assign(_fragments.size(), FragmentTiming());
+        auto decode = [&](std::size_t _index)
+        {
+            auto timeBegin = std::chrono::steady_clock::now();
+            const auto &stored = _fragments[_index];
+            decoded[_index] = DecodeFragment(_run_id, stored.plane_id, stored.board_id, _event_number, stored.words);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeBegin;
+            _timings[_index].plane_id = stored.plane_id;
+            _timings[_index].board_id = stored.board_id;
+            _timings[_index].decode_seconds = elapsed.count();
+        };
+
+        if (_pool == nullptr)
+        {
+            for (std::size_t i = 0; i < _fragments.size(); ++i)
+                decode(i);
+            return decoded;
+        }
+        std::vector<std::future<void>> futures;
+        futures.reserve(_fragments.size());
+        for (std::size_t i = 0; i < _fragments.size(); ++i)
+            futures.push_back(_pool->Submit([&decode, i]()
+                                            { decode(i); }));
+        for (auto &future : futures)
+            future.get();
+        return decoded;
+    }
+
+    BuiltEventStore::BuiltEventStore(uint32_t _nPlanes, uint32_t _nBoards,
+                                     const std::function<uint32_t(uint32_t, uint32_t, uint32_t)> &_fFADCChMapper)
+        : fNumberOfPlanes(_nPlanes), fNumberOfBoards(_nBoards),
+          fEventFragments(_nPlanes * _nBoards), fHasFragment(_nPlanes * _nBoards, false),
+          fMappedFADCCh(_nPlanes * _nBoards * FADCData::NumberOfChannels), fFADCChOfSlot(), fNumberOfFADCSlots(0), fFADCChTable()
+    {
+        const uint32_t nChsOfPlane = fNumberOfBoards * FADCData::NumberOfChannels;
+        bool direct = true;
+        for (uint32_t iPlane = 0; iPlane < fNumberOfPlanes; ++iPlane)
+        {
+            for (uint32_t iBoard = 0; iBoard < fNumberOfBoards; ++iBoard)
+            {
+                for (uint32_t iCh = 0; iCh < FADCData::NumberOfChannels; ++iCh)
+                {
+                    const uint32_t chMapped = _fFADCChMapper(iPlane, iBoard, iCh);
+                    fMappedFADCCh[(iPlane * fNumberOfBoards + iBoard) * FADCData::NumberOfChannels + iCh] = chMapped;
+                    if (chMapped < nChsOfPlane)
+                        fNumberOfFADCSlots = std::max(fNumberOfFADCSlots, chMapped + 1);
+                    else
+                        direct = false;
+                }
+            }
+        }
+
+        // Mapped channels beyond the number of channels of a plane (sparse or hashed ids) : slot = rank in the sorted channels of the plane
+        if (!direct)
+        {
+            fNumberOfFADCSlots = 0;
+            fFADCChOfSlot.resize(fNumberOfPlanes);
+            for (uint32_t iPlane = 0; iPlane < fNumberOfPlanes; ++iPlane)
+            {
+                uint32_t *mappedCh = fMappedFADCCh.data() + iPlane * nChsOfPlane;
+                auto &chOfSlot = fFADCChOfSlot[iPlane];
+                chOfSlot.assign(mappedCh, mappedCh + nChsOfPlane);
+                std::sort(chOfSlot.begin(), chOfSlot.end());
+                chOfSlot.erase(std::unique(chOfSlot.begin(), chOfSlot.end()), chOfSlot.end());
+                for (uint32_t i = 0; i < nChsOfPlane; ++i)
+                    mappedCh[i] = std::lower_bound(chOfSlot.begin(), chOfSlot.end(), mappedCh[i]) - chOfSlot.begin();
+                fNumberOfFADCSlots = std::max(fNumberOfFADCSlots, static_cast<uint32_t>(chOfSlot.size()));
+            }
+        }
+        fFADCChTable.assign(fNumberOfPlanes * fNumberOfFADCSlots, NoFADCCh);
+    }
+
+    uint32_t BuiltEventStore::FindFADCSlot(uint32_t _plane_id, uint32_t _ch) const
+    {
+        if (fFADCChOfSlot.empty())
+            return std::min(_ch, fNumberOfFADCSlots);
+        const auto &chOfSlot = fFADCChOfSlot[_plane_id];
+        auto it = std::lower_bound(chOfSlot.begin(), chOfSlot.end(), _ch);
+        if (it == chOfSlot.end() || *it != _ch)
+            return fNumberOfFADCSlots;
+        return it - chOfSlot.begin();
+    }
+
+    BuiltEventStore::AddFragmentResult BuiltEventStore::AddFragment(FragmentedEventData &&_frg)
+    {
+        AddFragmentResult result;
+        if (_frg.plane_id >= fNumberOfPlanes || _frg.board_id >= fNumberOfBoards)
+        {
+            result.out_of_topology = true;
+            return result;
+        }
+        const uint32_t slot = _frg.plane_id * fNumberOfBoards + _frg.board_id;
+        const uint32_t *mappedCh = fMappedFADCCh.data() + slot * FADCData::NumberOfChannels; // slots of the table
+        uint32_t *table = fFADCChTable.data() + _frg.plane_id * fNumberOfFADCSlots;
+
+        // Check duplication
+        // Duplication of fragment key
+        if (fHasFragment[slot])
+        {
+            result.fragment_key_duplication = true;
+            return result;
+        }
+        for (uint32_t iCh = 0; iCh < FADCData::NumberOfChannels; ++iCh)
+        {
+            // Duplication in inverted table is detected
+            if (table[mappedCh[iCh]] != NoFADCCh)
+            {
+                result.map_duplication = true;
+                return result;
+            }
+        }
+
+        // No duplication detected -> Add
+        for (uint32_t iCh = 0; iCh < FADCData::NumberOfChannels; ++iCh)
+            table[mappedCh[iCh]] = _frg.board_id * FADCData::NumberOfChannels + iCh;
+        fEventFragments[slot] = std::move(_frg);
+        fHasFragment[slot] = true;
+        result.good = true;
+        return result;
+    }
+
+    void BuiltEventStore::Clear()
+    {
+        for (std::size_t slot = 0; slot < fEventFragments.size(); ++slot)
+        {
+            if (fHasFragment[slot])
+                fEventFragments[slot] = FragmentedEventData();
+        }
+        std::fill(fHasFragment.begin(), fHasFragment.end(), false);
+        std::fill(fFADCChTable.begin(), fFADCChTable.end(), NoFADCCh);
+    }
+
+    std::vector<BuiltEventStore::ShortWordType> BuiltEventStore::GetSignal(uint32_t _plane_id, uint32_t _ch) const
+    {
+        if (_plane_id >= fNumberOfPlanes)
+            return {};
+        const uint32_t slot = FindFADCSlot(_plane_id, _ch);
+        if (slot >= fNumberOfFADCSlots)
+            return {};
+        const uint32_t entry = fFADCChTable[_plane_id * fNumberOfFADCSlots + slot];
+        if (entry == NoFADCCh)
+            return {};
+
+        const uint32_t boardId = entry / FADCData::NumberOfChannels;
+        const uint32_t ch = entry % FADCData::NumberOfChannels;
+        return fEventFragments[_plane_id * fNumberOfBoards + boardId].fadc.GetSignal(ch);
+    }
+
+    std::vector<uint32_t> BuiltEventStore::GetAvailableFADCCh(uint32_t _plane_id) const
+    {
+        std::vector<uint32_t> ret;
+        if (_plane_id >= fNumberOfPlanes)
+            return ret;
+        const uint32_t *table = fFADCChTable.data() + _plane_id * fNumberOfFADCSlots;
+        for (uint32_t slot = 0; slot < fNumberOfFADCSlots; ++slot) // in ascending order of ch in both ways of the slots
+        {
+            if (table[slot] != NoFADCCh)
+                ret.push_back(fFADCChOfSlot.empty() ? slot : fFADCChOfSlot[_plane_id][slot]);
+        }
+        return ret;
+    }
+}
\ No newline at end of file
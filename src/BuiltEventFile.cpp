@@ -0,0 +1,202 @@
+#include "BuiltEventFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "FileFingerprint.hpp"
+
+namespace MAIKo2Decoder
+{
+    BuiltEventFileWriter::BuiltEventFileWriter(const std::string &_path, uint32_t _run_id)
+        : fPath(_path), fTmpPath(_path + ".tmp"), fRunId(_run_id),
+          fOut(fTmpPath, std::ios::binary | std::ios::trunc), fAddress(sizeof(BuiltEventFileHeader)), fTable(), fClosed(false)
+    {
+        // The header is written by Close()
+        BuiltEventFileHeader header{};
+        fOut.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+
+    BuiltEventFileWriter::~BuiltEventFileWriter()
+    {
+        if (!fClosed)
+        {
+            fOut.close();
+            std::remove(fTmpPath.c_str());
+        }
+    }
+
+    bool BuiltEventFileWriter::Write(const StreamedBuiltEventBase &_event)
+    {
+        BuiltEventTableEntry entry;
+        entry.trigger_counter = _event.trigger_counter;
+        entry.flags = _event.IsComplete() ? 0 : BuiltEventTableEntry::IncompleteFlag;
+        entry.address = fAddress;
+
+        BuiltEventRecordHeader recordHeader{_event.trigger_counter, static_cast<uint32_t>(_event.fragments.size())};
+        fOut.write(reinterpret_cast<const char *>(&recordHeader), sizeof(recordHeader));
+        fAddress += sizeof(recordHeader);
+        for (const auto &frg : _event.fragments)
+        {
+            const auto &words = frg.words.GetWords();
+            BuiltEventFragmentHeader fragmentHeader{frg.plane_id, frg.board_id, static_cast<uint32_t>(words.size()),
+                                                    frg.words.GetEventFADCWordsOffset(), frg.words.GetEventTPCWordsOffset(), 0};
+            fOut.write(reinterpret_cast<const char *>(&fragmentHeader), sizeof(fragmentHeader));
+            fOut.write(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(WordType));
+            fAddress += sizeof(fragmentHeader) + words.size() * sizeof(WordType);
+        }
+        entry.length = fAddress - entry.address;
+        fTable.push_back(entry);
+        return fOut.good();
+    }
+
+    bool BuiltEventFileWriter::Close()
+    {
+        if (fClosed)
+            return false;
+        fClosed = true;
+
+        std::stable_sort(fTable.begin(), fTable.end(),
+                         [](const BuiltEventTableEntry &_lhs, const BuiltEventTableEntry &_rhs)
+                         { return _lhs.trigger_counter < _rhs.trigger_counter; });
+        fOut.write(reinterpret_cast<const char *>(fTable.data()), fTable.size() * sizeof(BuiltEventTableEntry));
+
+        BuiltEventFileHeader header;
+        std::memcpy(header.magic, BuiltEventFileHeader::Magic, sizeof(header.magic));
+        header.version = BuiltEventFileHeader::Version;
+        header.run_id = fRunId;
+        header.number_of_events = fTable.size();
+        header.table_address = fAddress;
+        header.table_checksum = HashBytesFNV1a(fTable.data(), fTable.size() * sizeof(BuiltEventTableEntry));
+        header.reserved = 0;
+        fOut.seekp(0);
+        fOut.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        fOut.close();
+        if (fOut.fail())
+        {
+            std::remove(fTmpPath.c_str());
+            return false;
+        }
+        return std::rename(fTmpPath.c_str(), fPath.c_str()) == 0;
+    }
+
+    BuiltEventFile::BuiltEventFile(const std::string &_path)
+        : fGood(false), fFd(open(_path.c_str(), O_RDONLY)), fHeader(), fTable()
+    {
+        struct stat st;
+        if (fFd < 0 || fstat(fFd, &st) != 0 || !ReadBytes(&fHeader, sizeof(fHeader), 0))
+            return;
+        if (std::memcmp(fHeader.magic, BuiltEventFileHeader::Magic, sizeof(fHeader.magic)) != 0 ||
+            fHeader.version != BuiltEventFileHeader::Version ||
+            static_cast<uint64_t>(st.st_size) != fHeader.table_address + fHeader.number_of_events * sizeof(BuiltEventTableEntry))
+            return;
+
+        fTable.resize(fHeader.number_of_events);
+        if (!ReadBytes(fTable.data(), fTable.size() * sizeof(BuiltEventTableEntry), fHeader.table_address) ||
+            HashBytesFNV1a(fTable.data(), fTable.size() * sizeof(BuiltEventTableEntry)) != fHeader.table_checksum)
+        {
+            fTable.clear();
+            return;
+        }
+        fGood = true;
+    }
+
+    BuiltEventFile::~BuiltEventFile()
+    {
+        if (fFd >= 0)
+            close(fFd);
+    }
+
+    bool BuiltEventFile::ReadBytes(void *_buffer, std::size_t _nBytes, uint64_t _address) const
+    {
+        char *buffer = static_cast<char *>(_buffer);
+        std::size_t nRead = 0;
+        while (nRead < _nBytes)
+        {
+            auto n = pread(fFd, buffer + nRead, _nBytes - nRead, _address + nRead);
+            if (n <= 0)
+                return false;
+            nRead += n;
+        }
+        return true;
+    }
+
+    const BuiltEventTableEntry *BuiltEventFile::Find(uint32_t _triggerCounter) const
+    {
+        auto it = std::lower_bound(fTable.begin(), fTable.end(), _triggerCounter,
+                                   [](const BuiltEventTableEntry &_entry, uint32_t _value)
+                                   { return _entry.trigger_counter < _value; });
+        if (it == fTable.end() || it->trigger_counter != _triggerCounter)
+            return nullptr;
+        return &(*it);
+    }
+
+    bool BuiltEventFile::ReadEvent(const BuiltEventTableEntry &_entry, std::vector<StoredFragment> &_fragments) const
+    {
+        _fragments.clear();
+        if (!fGood || _entry.length < sizeof(BuiltEventRecordHeader) ||
+            _entry.address + _entry.length > fHeader.table_address)
+            return false;
+
+        std::vector<char> buffer(_entry.length);
+        if (!ReadBytes(buffer.data(), buffer.size(), _entry.address))
+            return false;
+
+        BuiltEventRecordHeader recordHeader;
+        std::memcpy(&recordHeader, buffer.data(), sizeof(recordHeader));
+        if (recordHeader.trigger_counter != _entry.trigger_counter)
+            return false;
+        std::size_t pos = sizeof(recordHeader);
+        for (uint32_t iFragment = 0; iFragment < recordHeader.number_of_fragments; ++iFragment)
+        {
+            BuiltEventFragmentHeader fragmentHeader;
+            if (pos + sizeof(fragmentHeader) > buffer.size())
+                return false;
+            std::memcpy(&fragmentHeader, buffer.data() + pos, sizeof(fragmentHeader));
+            pos += sizeof(fragmentHeader);
+            const std::size_t nBytes = fragmentHeader.number_of_words * sizeof(WordType);
+            if (pos + nBytes > buffer.size())
+                return false;
+            std::vector<WordType> words(fragmentHeader.number_of_words);
+            std::memcpy(words.data(), buffer.data() + pos, nBytes);
+            pos += nBytes;
+
+            _fragments.push_back(StoredFragment{fragmentHeader.plane_id, fragmentHeader.board_id,
+                                                EventWordsBuffer(std::move(words),
+                                                                 fragmentHeader.event_fadc_words_offset,
+                                                                 fragmentHeader.event_tpc_words_offset)});
+            if (!_fragments.back().words.IsValid())
+                return false;
+        }
+        return true;
+    }
+
+    bool BuiltEventFile::ReadEvent(uint32_t _triggerCounter, std::vector<StoredFragment> &_fragments) const
+    {
+        const auto *entry = Find(_triggerCounter);
+        if (entry == nullptr)
+        {
+            _fragments.clear();
+            return false;
+        }
+        return ReadEvent(*entry, _fragments);
+    }
+
+    bool BuiltEventFile::ReadEvent(uint32_t _triggerCounter, BuiltEventStore &_event) const
+    {
+        std::vector<StoredFragment> fragments;
+        if (!ReadEvent(_triggerCounter, fragments))
+            return false;
+
+        bool good = true;
+        for (const auto &stored : fragments)
+        {
+            auto frg = DecodeFragment(fHeader.run_id, stored.plane_id, stored.board_id, _triggerCounter, stored.words);
+            if (!_event.AddFragment(std::move(frg)).good)
+                good = false;
+        }
+        return good;
+    }
+}
\ No newline at end of file
@@ -3,7 +3,7 @@
 namespace MAIKo2Decoder
 {
 
-    CounterData::CounterData(const std::vector<WordType> &_words)
+    CounterData::CounterData(WordsView _words)
         : fGood(false), fTriggerCounter(0), fClockCounter(0), fCounter2(0)
     {
         if (_words.size() == 3)
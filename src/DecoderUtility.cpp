@@ -5,8 +5,72 @@
 #include <sstream>
 #include <regex>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MAIKO2DECODER_X86_KERNELS
+#endif
+
 namespace MAIKo2Decoder
 {
+    // Kernels of CorrectRawWords(). _src and _dst may be the same.
+    static void CorrectRawWordsScalar(const WordType *_src, WordType *_dst, std::size_t _nWords)
+    {
+        for (std::size_t i = 0; i < _nWords; ++i)
+            _dst[i] = CorrectRawWord(_src[i]);
+    }
+
+#ifdef MAIKO2DECODER_X86_KERNELS
+    __attribute__((target("ssse3"))) static void CorrectRawWordsSSSE3(const WordType *_src, WordType *_dst, std::size_t _nWords)
+    {
+        const __m128i shuffle = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        std::size_t i = 0;
+        for (; i + 4 <= _nWords; i += 4) // 4 words at once
+        {
+            __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(_dst + i), _mm_shuffle_epi8(words, shuffle));
+        }
+        CorrectRawWordsScalar(_src + i, _dst + i, _nWords - i);
+    }
+
+    __attribute__((target("avx2"))) static void CorrectRawWordsAVX2(const WordType *_src, WordType *_dst, std::size_t _nWords)
+    {
+        const __m256i shuffle = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        std::size_t i = 0;
+        for (; i + 16 <= _nWords; i += 16) // 16 words at once
+        {
+            __m256i words0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_src + i));
+            __m256i words1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_src + i + 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(_dst + i), _mm256_shuffle_epi8(words0, shuffle));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(_dst + i + 8), _mm256_shuffle_epi8(words1, shuffle));
+        }
+        CorrectRawWordsScalar(_src + i, _dst + i, _nWords - i);
+    }
+#endif
+
+    struct CorrectRawWordsKernel
+    {
+        void (*function)(const WordType *, WordType *, std::size_t);
+        const char *name;
+    };
+
+    // The kernel is selected once, depending on the CPU.
+    static const CorrectRawWordsKernel &GetCorrectRawWordsKernel()
+    {
+        static const CorrectRawWordsKernel kernel = []() -> CorrectRawWordsKernel
+        {
+#ifdef MAIKO2DECODER_X86_KERNELS
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return {CorrectRawWordsAVX2, "avx2"};
+            if (__builtin_cpu_supports("ssse3"))
+                return {CorrectRawWordsSSSE3, "ssse3"};
+#endif
+            return {CorrectRawWordsScalar, "scalar"};
+        }();
+        return kernel;
+    }
+
     // Return given 32-bit word in raw data, which is originally encoded in big endian, in right byte order.
     WordType CorrectRawWord(const WordType &_wordIn)
     {
@@ -30,12 +94,28 @@ namespace MAIKo2Decoder
     std::vector<WordType> ReadNextWords(std::ifstream &_fIn, unsigned int _nWords)
     {
         std::vector<WordType> ret(_nWords, 0x00000000);
-        std::for_each(ret.begin(), ret.end(),
-                      [&_fIn](auto &_val)
-                      { _val = ReadNextWord(_fIn); });
+        _fIn.read(reinterpret_cast<char *>(ret.data()), _nWords * sizeof(WordType));
+        CorrectRawWords(ret.data(), _nWords);
         return ret;
     }
 
+    // Correct byte order of _nWords raw words in _words in place.
+    void CorrectRawWords(WordType *_words, std::size_t _nWords)
+    {
+        GetCorrectRawWordsKernel().function(_words, _words, _nWords);
+    }
+
+    // Copy _nWords raw words from _src to _dst with their byte order corrected.
+    void CorrectRawWords(const WordType *_src, WordType *_dst, std::size_t _nWords)
+    {
+        GetCorrectRawWordsKernel().function(_src, _dst, _nWords);
+    }
+
+    std::string GetCorrectRawWordsKernelName()
+    {
+        return GetCorrectRawWordsKernel().name;
+    }
+
     // Return zero-filled string with its width is _digits
     // eg) _num:10, _digits:4 -> return "0010"
     std::string MakeZeroFilledUnsignedInteger(unsigned int _num, unsigned int _digits)
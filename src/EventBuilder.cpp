@@ -0,0 +1,228 @@
+#include "EventBuilder.hpp"
+#include <fstream>
+#include <utility>
+#include <chrono>
+#include <future>
+#include <algorithm>
+#include "DecoderUtility.hpp"
+#include "DecoderFormat.hpp"
+#include "RawWordsFraming.hpp"
+
+namespace MAIKo2Decoder
+{
+    BoardEventScanner::BoardEventScanner(uint32_t _plane_id, uint32_t _board_id, std::vector<std::string> _filePaths)
+        : fPlaneId(_plane_id), fBoardId(_board_id), fFilePaths(std::move(_filePaths)),
+          fFileIndex(0), fFile(), fPos(NoWordPosition), fResult(), fFileResults()
+    {
+    }
+
+    bool BoardEventScanner::OpenFile()
+    {
+        fResult = StreamRawDataResult();
+        fResult.input.fileName = fFilePaths[fFileIndex];
+        fResult.input.engine = StreamRawDataEngine::MemoryMap;
+        fFile = MappedFile(fFilePaths[fFileIndex]);
+        if (!fFile.IsGood())
+        {
+            fResult.fileNotFound = true;
+            return false;
+        }
+        fFile.AdviseSequential();
+        fPos = FindFirstEventHeader(reinterpret_cast<const WordType *>(fFile.GetData()), fFile.GetSize() / sizeof(WordType));
+        if (fPos == NoWordPosition)
+        {
+            fResult.noEventFound = true;
+            return false;
+        }
+        return true;
+    }
+
+    void BoardEventScanner::CloseFile()
+    {
+        fFileResults.push_back(fResult);
+        fFile = MappedFile();
+        fPos = NoWordPosition;
+        ++fFileIndex;
+    }
+
+    bool BoardEventScanner::Next(ScannedFragment &_fragment)
+    {
+        while (fFileIndex < fFilePaths.size())
+        {
+            if (fPos == NoWordPosition && !OpenFile())
+            {
+                CloseFile();
+                continue;
+            }
+
+            const WordType *raw = reinterpret_cast<const WordType *>(fFile.GetData());
+            const std::size_t nWords = fFile.GetSize() / sizeof(WordType); // Trailing bytes shorter than a word are ignored.
+            if (fPos == nWords) // All events in the file are scanned
+            {
+                fResult.goodFlag = true;
+                CloseFile();
+                continue;
+            }
+
+            // Events are contiguous after the first one, and each of them ends at a footer passing the strict check.
+            const std::size_t posEnd = FindEventEnd(raw, nWords, fPos);
+            if (posEnd == NoWordPosition)
+            {
+                fResult.noEventFooter = true;
+                CloseFile();
+                continue;
+            }
+            auto timeBegin = std::chrono::steady_clock::now();
+            std::vector<WordType> wordsEvent(posEnd - fPos);
+            CorrectRawWords(raw + fPos, wordsEvent.data(), wordsEvent.size());
+            ++fResult.number_of_events_processed;
+
+            _fragment.plane_id = fPlaneId;
+            _fragment.board_id = fBoardId;
+            _fragment.file_number = fFileIndex;
+            _fragment.event_id = fResult.number_of_events_processed;
+            _fragment.event_data_address = fPos * sizeof(WordType);
+            _fragment.words = EventWordsBuffer(std::move(wordsEvent));
+            if (!_fragment.words.IsValid())
+            {
+                fResult.eventFormatError = true;
+                CloseFile();
+                continue;
+            }
+            _fragment.trigger_counter = _fragment.words.GetCounterWords().at(0);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeBegin;
+            _fragment.read_seconds = elapsed.count();
+
+            fPos = posEnd;
+            fResult.number_of_bytes_processed = posEnd * sizeof(WordType);
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<std::string> ListRawDataFiles(const std::function<std::string(uint32_t)> &_pathOfFile)
+    {
+        std::vector<std::string> filePaths;
+        for (uint32_t fileNumber = 0;; ++fileNumber)
+        {
+            auto filePath = _pathOfFile(fileNumber);
+            if (!std::ifstream(filePath).good())
+                break;
+            filePaths.push_back(filePath);
+        }
+        return filePaths;
+    }
+
+    EventBuilder::EventBuilder(uint32_t _run_id, std::vector<BoardEventScanner> _scanners, bool _decodeFragments,
+                               WorkStealingPool *_pool)
+        : fRunId(_run_id), fScanners(std::move(_scanners)), fDecodeFragments(_decodeFragments), fPool(_pool),
+          fHeads(fScanners.size()), fTaken(fScanners.size()), fScannersTaken(), fDecoded(fScanners.size()),
+          fHasNext(fScanners.size()), fHeap(),
+          fNumberOfEventsBuilt(0), fNumberOfIncompleteEvents(0)
+    {
+        for (std::size_t iScanner = 0; iScanner < fScanners.size(); ++iScanner)
+            Advance(iScanner);
+    }
+
+    void EventBuilder::Advance(std::size_t _index)
+    {
+        if (fScanners[_index].Next(fHeads[_index]))
+            fHeap.emplace(fHeads[_index].trigger_counter, _index);
+    }
+
+    bool EventBuilder::BuildNext(StreamedBuiltEventBase &_event, BuiltEventStore &_built)
+    {
+        if (fHeap.empty())
+            return false;
+
+        auto timeBegin = std::chrono::steady_clock::now();
+        _event.Clear();
+        _built.Clear();
+        _event.trigger_counter = fHeap.top().first;
+
+        // 1. Take the fragments with the smallest trigger counter (at most one from each scanner, as it is not advanced yet)
+        std::fill(fTaken.begin(), fTaken.end(), false);
+        fScannersTaken.clear();
+        while (!fHeap.empty() && fHeap.top().first == _event.trigger_counter)
+        {
+            const std::size_t iScanner = fHeap.top().second;
+            fHeap.pop();
+            fTaken[iScanner] = true;
+            fScannersTaken.push_back(iScanner);
+            _event.fragments.push_back(std::move(fHeads[iScanner])); // fHeads[iScanner] is read again below
+        }
+
+        // 2. Decode each fragment and read the next one of its scanner. Each task touches only its own elements.
+        const std::size_t nFragments = fScannersTaken.size();
+        _event.fragment_timings.resize(nFragments);
+        auto processFragment = [&](std::size_t _index)
+        {
+            const ScannedFragment &frg = _event.fragments[_index];
+            FragmentTiming &timing = _event.fragment_timings[_index];
+            timing.plane_id = frg.plane_id;
+            timing.board_id = frg.board_id;
+            timing.read_seconds = frg.read_seconds;
+            if (fDecodeFragments)
+            {
+                auto timeDecodeBegin = std::chrono::steady_clock::now();
+                fDecoded[_index] = DecodeFragment(fRunId, frg.plane_id, frg.board_id, frg.trigger_counter, frg.words);
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeDecodeBegin;
+                timing.decode_seconds = elapsed.count();
+            }
+            const std::size_t iScanner = fScannersTaken[_index];
+            fHasNext[_index] = fScanners[iScanner].Next(fHeads[iScanner]);
+        };
+        if (fPool == nullptr || nFragments < 2)
+        {
+            for (std::size_t i = 0; i < nFragments; ++i)
+                processFragment(i);
+        }
+        else
+        {
+            std::vector<std::future<void>> futures;
+            futures.reserve(nFragments);
+            for (std::size_t i = 0; i < nFragments; ++i)
+                futures.push_back(fPool->Submit([&processFragment, i]()
+                                                { processFragment(i); }));
+            for (auto &future : futures)
+                future.get();
+        }
+        for (std::size_t i = 0; i < nFragments; ++i)
+        {
+            if (fHasNext[i])
+                fHeap.emplace(fHeads[fScannersTaken[i]].trigger_counter, fScannersTaken[i]);
+        }
+
+        // 3. The same trigger counter again in a board
+        while (!fHeap.empty() && fHeap.top().first == _event.trigger_counter)
+        {
+            const std::size_t iScanner = fHeap.top().second;
+            fHeap.pop();
+            _event.duplicate_fragments.push_back({fHeads[iScanner].plane_id, fHeads[iScanner].board_id});
+            Advance(iScanner);
+        }
+
+        // 4. Build in the order of the scanners
+        if (fDecodeFragments)
+        {
+            for (std::size_t i = 0; i < nFragments; ++i)
+            {
+                const BoardOfFragment board{fDecoded[i].plane_id, fDecoded[i].board_id};
+                if (!_built.AddFragment(std::move(fDecoded[i])).good)
+                    _event.duplicate_fragments.push_back(board);
+            }
+        }
+        for (std::size_t iScanner = 0; iScanner < fScanners.size(); ++iScanner)
+        {
+            if (!fTaken[iScanner])
+                _event.missing_fragments.push_back({fScanners[iScanner].GetPlaneId(), fScanners[iScanner].GetBoardId()});
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeBegin;
+        _event.build_seconds = elapsed.count();
+        ++fNumberOfEventsBuilt;
+        if (!_event.IsComplete())
+            ++fNumberOfIncompleteEvents;
+        return true;
+    }
+}
\ No newline at end of file
@@ -4,42 +4,36 @@
 namespace MAIKo2Decoder
 {
 
-    std::vector<WordType> EventWordsBuffer::GetCounterWords() const
+    WordsView EventWordsBuffer::GetCounterWords() const
     {
         if (!IsValid())
             return {};
-        std::vector<WordType> ret;
-        std::copy(fWords.begin() + 1, fWords.begin() + LengthOfCounterWords + 1, std::back_inserter(ret));
-        return ret;
+        return WordsView(fWords.data() + 1, LengthOfCounterWords);
     }
 
-    std::vector<WordType> EventWordsBuffer::GetFADCWords() const
+    WordsView EventWordsBuffer::GetFADCWords() const
     {
         if (!IsValid())
             return {};
         else if (fEventFADCWordsOffset == 0 &&
                  fEventTPCWordsOffset == 0)
             return {};
-        std::vector<WordType> ret;
-        std::copy(fWords.begin() + fEventFADCWordsOffset,
-                  fWords.begin() + fEventTPCWordsOffset - 1, std::back_inserter(ret));
-        return ret;
+        return WordsView(fWords.data() + fEventFADCWordsOffset,
+                         fEventTPCWordsOffset - 1 - fEventFADCWordsOffset);
     }
 
-    std::vector<WordType> EventWordsBuffer::GetTPCWords() const
+    WordsView EventWordsBuffer::GetTPCWords() const
     {
         if (!IsValid())
             return {};
         else if (fEventFADCWordsOffset == 0 &&
                  fEventTPCWordsOffset == 0)
             return {};
-        std::vector<WordType> ret;
-        std::copy(fWords.begin() + fEventTPCWordsOffset,
-                  fWords.end() - 1, std::back_inserter(ret));
-        return ret;
+        return WordsView(fWords.data() + fEventTPCWordsOffset,
+                         fWords.size() - 1 - fEventTPCWordsOffset);
     }
 
-    EventWordsBuffer::ValidationResult EventWordsBuffer::EventValidation(const std::vector<WordType> &_fWords)
+    EventWordsBuffer::ValidationResult EventWordsBuffer::EventValidation(WordsView _fWords)
     {
         ValidationResult result;
         result.fGoodEvent = false;
@@ -113,7 +107,7 @@ namespace MAIKo2Decoder
         return result;
     }
 
-    bool EventWordsBuffer::CheckIndex(const std::vector<WordType> &_fWords,
+    bool EventWordsBuffer::CheckIndex(WordsView _fWords,
                                       unsigned int _fEventFADCWordOffset, unsigned int _fEventTPCWordOffset)
     {
         if (_fWords.size() == 1 + LengthOfCounterWords + 1 &&
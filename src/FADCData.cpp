@@ -1,10 +1,57 @@
 #include "FADCData.hpp"
+#include <utility>
 #include <sstream>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MAIKO2DECODER_X86_KERNELS
+#endif
+
 namespace MAIKo2Decoder
 {
-    FADCData::FADCData(const std::vector<WordType> &_words)
-        : fGood(false), fEmpty(false), fSignals(), fErrorLog()
+#ifdef MAIKO2DECODER_X86_KERNELS
+    // Check the format and channel bits of 4 clocks (8 words) at once.
+    // SSE2 is always available on x86-64.
+    static bool CheckFourClocksSSE2(__m128i _a, __m128i _b)
+    {
+        // word1 : [ch0 | ch1], word2 : [ch2 | ch3] with format bits 01 and channel bits in each 16-bit sample
+        const __m128i formatMask = _mm_set1_epi32(0xf000f000);
+        const __m128i formatExpected = _mm_setr_epi32(0x40005000, 0x60007000, 0x40005000, 0x60007000);
+        __m128i good = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(_a, formatMask), formatExpected),
+                                     _mm_cmpeq_epi32(_mm_and_si128(_b, formatMask), formatExpected));
+        return _mm_movemask_epi8(good) == 0xffff;
+    }
+
+    // Check 4 clocks (8 words) and unpack their 10-bit signals.
+    // Return false without writing anything if any sample in the 4 clocks is in the wrong format.
+    static bool UnpackFourClocksSSE2(const WordType *_words,
+                                     FADCData::ShortWordType *_ch0, FADCData::ShortWordType *_ch1,
+                                     FADCData::ShortWordType *_ch2, FADCData::ShortWordType *_ch3)
+    {
+        const __m128i signalMask = _mm_set1_epi32(0x03ff03ff);
+
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_words));     // clock 0, 1
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_words + 4)); // clock 2, 3
+        if (!CheckFourClocksSSE2(a, b))
+            return false;
+
+        // 16-bit lanes (little endian) : a = [ch1, ch0, ch3, ch2] x clock 0, 1 and b = same for clock 2, 3
+        a = _mm_and_si128(a, signalMask);
+        b = _mm_and_si128(b, signalMask);
+        __m128i lo = _mm_unpacklo_epi16(a, b);    // ch1_0 ch1_2 ch0_0 ch0_2 ch3_0 ch3_2 ch2_0 ch2_2
+        __m128i hi = _mm_unpackhi_epi16(a, b);    // ch1_1 ch1_3 ch0_1 ch0_3 ch3_1 ch3_3 ch2_1 ch2_3
+        __m128i ch10 = _mm_unpacklo_epi16(lo, hi); // ch1_0 -- ch1_3, ch0_0 -- ch0_3
+        __m128i ch32 = _mm_unpackhi_epi16(lo, hi); // ch3_0 -- ch3_3, ch2_0 -- ch2_3
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(_ch1), ch10);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(_ch0), _mm_unpackhi_epi64(ch10, ch10));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(_ch3), ch32);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(_ch2), _mm_unpackhi_epi64(ch32, ch32));
+        return true;
+    }
+#endif
+
+    FADCData::FADCData(WordsView _words)
+        : fGood(false), fEmpty(false), fSignals(), fErrors()
     {
         if (_words.size() == 0)
         {
@@ -12,63 +59,51 @@ namespace MAIKo2Decoder
         }
         else if (_words.size() % 2 == 0)
         {
-            for (auto it = _words.begin(); it != _words.end(); it = it + 2)
+            // Allocate the signals at once. Shrunk later if some clocks are rejected.
+            const std::size_t nClocks = _words.size() / 2;
+            for (auto &signal : fSignals)
+                signal.resize(nClocks);
+
+            std::size_t nAccepted = 0;
+            std::size_t iClock = 0;
+#ifdef MAIKO2DECODER_X86_KERNELS
+            // 4 clocks at once. Only the blocks failing the vectorized check are checked clock by clock.
+            for (; iClock + 4 <= nClocks; iClock += 4)
             {
-                auto word1 = *it;
-                auto word2 = *(it + 1);
-
-                ShortWordType sWord0 = (word1 & 0xffff0000) >> 16;
-                ShortWordType sWord1 = (word1 & 0x0000ffff);
-                ShortWordType sWord2 = (word2 & 0xffff0000) >> 16;
-                ShortWordType sWord3 = (word2 & 0x0000ffff);
-
-                if (CheckFormat(sWord0) && GetChannel(sWord0) == 0 &&
-                    CheckFormat(sWord1) && GetChannel(sWord1) == 1 &&
-                    CheckFormat(sWord2) && GetChannel(sWord2) == 2 &&
-                    CheckFormat(sWord3) && GetChannel(sWord3) == 3)
+                if (UnpackFourClocksSSE2(_words.data() + 2 * iClock,
+                                         fSignals[0].data() + nAccepted, fSignals[1].data() + nAccepted,
+                                         fSignals[2].data() + nAccepted, fSignals[3].data() + nAccepted))
                 {
-                    fSignals.at(0).push_back(GetSignal(sWord0));
-                    fSignals.at(1).push_back(GetSignal(sWord1));
-                    fSignals.at(2).push_back(GetSignal(sWord2));
-                    fSignals.at(3).push_back(GetSignal(sWord3));
+                    nAccepted += 4;
+                    continue;
                 }
-                else
+                for (std::size_t iClockInBlock = iClock; iClockInBlock < iClock + 4; ++iClockInBlock)
                 {
-                    std::ostringstream tmpErrorLog;
-                    tmpErrorLog << "Format Error in " << (it - _words.begin()) / 2 << " th clock " << std::endl;
-                    tmpErrorLog << "    0: " << std::hex << sWord0 << ", "
-                                << "Format " << (0xc000 & sWord0) << " (== 0x4000?), " << std::dec
-                                << "Channel " << GetChannel(sWord0) << " (== 0?), "
-                                << "Signal " << GetSignal(sWord0) << std::endl;
-                    tmpErrorLog << "    1: " << std::hex << sWord1 << ", "
-                                << "Format " << (0xc000 & sWord1) << " (== 0x4000?), " << std::dec
-                                << "Channel " << GetChannel(sWord1) << " (== 1?), "
-                                << "Signal " << GetSignal(sWord1) << std::endl;
-                    tmpErrorLog << "    2: " << std::hex << sWord1 << ", "
-                                << "Format " << (0xc000 & sWord2) << " (== 0x4000?), " << std::dec
-                                << "Channel " << GetChannel(sWord2) << " (== 2?), "
-                                << "Signal " << GetSignal(sWord2) << std::endl;
-                    tmpErrorLog << "    3: " << std::hex << sWord3 << ", "
-                                << "Format " << (0xc000 & sWord3) << " (== 0x4000?), " << std::dec
-                                << "Channel " << GetChannel(sWord3) << " (== 3?), "
-                                << "Signal " << GetSignal(sWord3) << std::endl;
-                    fErrorLog += tmpErrorLog.str();
+                    if (UnpackClock(_words[2 * iClockInBlock], _words[2 * iClockInBlock + 1], iClockInBlock, nAccepted))
+                        ++nAccepted;
                 }
             }
+#endif
+            for (; iClock < nClocks; ++iClock)
+            {
+                if (UnpackClock(_words[2 * iClock], _words[2 * iClock + 1], iClock, nAccepted))
+                    ++nAccepted;
+            }
+
+            for (auto &signal : fSignals)
+                signal.resize(nAccepted);
         }
         else
         {
-            std::ostringstream tmpErrorLog;
-            tmpErrorLog << "Format error: The length of FADC data must be 2n, but that of this event is " << _words.size() << std::endl;
-            fErrorLog += tmpErrorLog.str();
+            fErrors.Add(DecodeErrorCode::FADCLengthNotEven, _words.size());
         }
 
         // Check validity
-        // 2 words == 1 clock && No error log ?
+        // 2 words == 1 clock && No error ?
         const int signalLengthExpected = _words.size() / 2;
         const int signalLengthAccepted = fSignals.at(0).size();
         if (signalLengthExpected == signalLengthAccepted &&
-            fErrorLog == "")
+            fErrors.IsEmpty())
         {
             fGood = true;
         }
@@ -78,15 +113,103 @@ namespace MAIKo2Decoder
         }
     }
 
+    bool FADCData::CheckStructure(WordsView _words)
+    {
+        if (_words.size() % 2 != 0)
+            return false;
+
+        const std::size_t nClocks = _words.size() / 2;
+        std::size_t iClock = 0;
+#ifdef MAIKO2DECODER_X86_KERNELS
+        for (; iClock + 4 <= nClocks; iClock += 4)
+        {
+            const WordType *words = _words.data() + 2 * iClock;
+            if (!CheckFourClocksSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(words)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + 4))))
+                return false;
+        }
+#endif
+        for (; iClock < nClocks; ++iClock)
+        {
+            if (!CheckClock(_words[2 * iClock], _words[2 * iClock + 1]))
+                return false;
+        }
+        return true;
+    }
+
+    bool FADCData::UnpackClock(WordType _word1, WordType _word2, std::size_t _clock, std::size_t _pos)
+    {
+        ShortWordType sWord0 = (_word1 & 0xffff0000) >> 16;
+        ShortWordType sWord1 = (_word1 & 0x0000ffff);
+        ShortWordType sWord2 = (_word2 & 0xffff0000) >> 16;
+        ShortWordType sWord3 = (_word2 & 0x0000ffff);
+
+        if (CheckClock(_word1, _word2))
+        {
+            fSignals[0][_pos] = GetSignal(sWord0);
+            fSignals[1][_pos] = GetSignal(sWord1);
+            fSignals[2][_pos] = GetSignal(sWord2);
+            fSignals[3][_pos] = GetSignal(sWord3);
+            return true;
+        }
+
+        // Detail is recorded only here, in the slow path
+        const WordType words[2] = {_word1, _word2};
+        fErrors.Add(DecodeErrorCode::FADCSampleFormat, _clock, words, 2);
+        return false;
+    }
+
+    std::string FADCData::GetErrorLog() const
+    {
+        std::ostringstream tmpErrorLog;
+        for (const auto &error : fErrors.GetErrors())
+        {
+            if (error.code == DecodeErrorCode::FADCLengthNotEven)
+            {
+                tmpErrorLog << "Format error: The length of FADC data must be 2n, but that of this event is " << error.offset << std::endl;
+                continue;
+            }
+
+            std::array<ShortWordType, NumberOfChannels> sWords{
+                (ShortWordType)((error.words[0] & 0xffff0000) >> 16),
+                (ShortWordType)(error.words[0] & 0x0000ffff),
+                (ShortWordType)((error.words[1] & 0xffff0000) >> 16),
+                (ShortWordType)(error.words[1] & 0x0000ffff)};
+            tmpErrorLog << "Format Error in " << error.offset << " th clock " << std::endl;
+            for (unsigned int iCh = 0; iCh < NumberOfChannels; ++iCh)
+            {
+                tmpErrorLog << "    " << iCh << ": " << std::hex << sWords[iCh] << ", "
+                            << "Format " << (0xc000 & sWords[iCh]) << " (== 0x4000?), " << std::dec
+                            << "Channel " << GetChannel(sWords[iCh]) << " (== " << iCh << "?), "
+                            << "Signal " << GetSignal(sWords[iCh]) << std::endl;
+            }
+        }
+        if (fErrors.IsTruncated())
+            tmpErrorLog << "... and " << fErrors.GetNumberOfErrors() - fErrors.GetErrors().size() << " more errors" << std::endl;
+        return tmpErrorLog.str();
+    }
+
     FADCData::FADCData(const FADCData &_rhs)
-        : fGood(_rhs.fGood), fEmpty(_rhs.fEmpty), fSignals(_rhs.fSignals), fErrorLog(_rhs.fErrorLog) {}
+        : fGood(_rhs.fGood), fEmpty(_rhs.fEmpty), fSignals(_rhs.fSignals), fErrors(_rhs.fErrors) {}
 
     FADCData &FADCData::operator=(const FADCData &_rhs)
     {
         fGood = _rhs.fGood;
         fEmpty = _rhs.fEmpty;
         fSignals = _rhs.fSignals;
-        fErrorLog = fErrorLog;
+        fErrors = _rhs.fErrors;
+        return *this;
+    }
+
+    FADCData::FADCData(FADCData &&_rhs) noexcept
+        : fGood(_rhs.fGood), fEmpty(_rhs.fEmpty), fSignals(std::move(_rhs.fSignals)), fErrors(std::move(_rhs.fErrors)) {}
+
+    FADCData &FADCData::operator=(FADCData &&_rhs) noexcept
+    {
+        fGood = _rhs.fGood;
+        fEmpty = _rhs.fEmpty;
+        fSignals = std::move(_rhs.fSignals);
+        fErrors = std::move(_rhs.fErrors);
         return *this;
     }
-}
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "FileFingerprint.hpp"
+#include <vector>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MAIKo2Decoder
+{
+    static const uint64_t FNV1aPrime = 0x100000001b3;
+
+    uint64_t HashBytesFNV1a(const void *_bytes, std::size_t _nBytes, uint64_t _hash)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(_bytes);
+        for (std::size_t i = 0; i < _nBytes; ++i)
+        {
+            _hash ^= bytes[i];
+            _hash *= FNV1aPrime;
+        }
+        return _hash;
+    }
+
+    // Hash [_begin, _end) of the file. Return false if the bytes could not be read.
+    static bool HashFileRange(int _fd, uint64_t _begin, uint64_t _end, std::vector<unsigned char> &_buffer, uint64_t &_hash)
+    {
+        _buffer.resize(_end - _begin);
+        std::size_t nRead = 0;
+        while (nRead < _buffer.size())
+        {
+            auto n = pread(_fd, _buffer.data() + nRead, _buffer.size() - nRead, _begin + nRead);
+            if (n <= 0)
+                return false;
+            nRead += n;
+        }
+        _hash = HashBytesFNV1a(_buffer.data(), _buffer.size(), _hash);
+        return true;
+    }
+
+    static FileFingerprint TakeFingerprint(const std::string &_filePath, bool _wholeFile, uint64_t _size)
+    {
+        FileFingerprint result;
+        int fd = open(_filePath.c_str(), O_RDONLY);
+        if (fd < 0)
+            return result;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (!_wholeFile && static_cast<uint64_t>(st.st_size) < _size))
+        {
+            close(fd);
+            return result;
+        }
+        result.size = _wholeFile ? st.st_size : _size;
+        result.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+        // size, [0, headEnd) and [tailBegin, size)
+        const uint64_t headEnd = (result.size < FileFingerprint::NumberOfBytesHashed) ? result.size : FileFingerprint::NumberOfBytesHashed;
+        const uint64_t tailBegin = (result.size - headEnd < FileFingerprint::NumberOfBytesHashed) ? headEnd : result.size - FileFingerprint::NumberOfBytesHashed;
+        unsigned char sizeBytes[8];
+        for (unsigned int i = 0; i < 8; ++i)
+            sizeBytes[i] = (result.size >> (8 * i)) & 0xff;
+        uint64_t hash = HashBytesFNV1a(sizeBytes, 8);
+        std::vector<unsigned char> buffer;
+        result.good = HashFileRange(fd, 0, headEnd, buffer, hash) &&
+                      HashFileRange(fd, tailBegin, result.size, buffer, hash);
+        result.fingerprint = hash;
+        close(fd);
+        return result;
+    }
+
+    FileFingerprint TakeFileFingerprint(const std::string &_filePath)
+    {
+        return TakeFingerprint(_filePath, true, 0);
+    }
+
+    FileFingerprint TakeFileFingerprint(const std::string &_filePath, uint64_t _size)
+    {
+        return TakeFingerprint(_filePath, false, _size);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "MappedFile.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MAIKo2Decoder
+{
+
+    MappedFile::MappedFile(const std::string &_filePath)
+        : fGood(false), fData(nullptr), fSize(0)
+    {
+        int fd = open(_filePath.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            return;
+        }
+
+        if (st.st_size == 0) // mmap() does not accept zero length
+        {
+            close(fd);
+            fGood = true;
+            return;
+        }
+
+        void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // The mapping stays valid after closing the descriptor.
+        if (addr == MAP_FAILED)
+            return;
+
+        fGood = true;
+        fData = static_cast<char *>(addr);
+        fSize = st.st_size;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Release();
+    }
+
+    MappedFile::MappedFile(MappedFile &&_rhs) noexcept
+        : fGood(_rhs.fGood), fData(_rhs.fData), fSize(_rhs.fSize)
+    {
+        _rhs.fGood = false;
+        _rhs.fData = nullptr;
+        _rhs.fSize = 0;
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&_rhs) noexcept
+    {
+        if (this != &_rhs)
+        {
+            Release();
+            fGood = _rhs.fGood;
+            fData = _rhs.fData;
+            fSize = _rhs.fSize;
+            _rhs.fGood = false;
+            _rhs.fData = nullptr;
+            _rhs.fSize = 0;
+        }
+        return *this;
+    }
+
+    void MappedFile::AdviseSequential() const
+    {
+        if (fData != nullptr)
+            madvise(fData, fSize, MADV_SEQUENTIAL);
+    }
+
+    void MappedFile::AdviseRandom() const
+    {
+        if (fData != nullptr)
+            madvise(fData, fSize, MADV_RANDOM);
+    }
+
+    void MappedFile::Release()
+    {
+        if (fData != nullptr)
+            munmap(fData, fSize);
+        fGood = false;
+        fData = nullptr;
+        fSize = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "RawWordsFraming.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MAIKO2DECODER_X86_KERNELS
+#endif
+
+namespace MAIKo2Decoder
+{
+    // Kernels of FindRawWord()
+    static std::size_t FindRawWordScalar(const WordType *_raw, std::size_t _begin, std::size_t _end, WordType _rawPattern)
+    {
+        for (std::size_t pos = _begin; pos < _end; ++pos)
+        {
+            if (_raw[pos] == _rawPattern)
+                return pos;
+        }
+        return _end;
+    }
+
+#ifdef MAIKO2DECODER_X86_KERNELS
+    // SSE2 is always available on x86-64.
+    static std::size_t FindRawWordSSE2(const WordType *_raw, std::size_t _begin, std::size_t _end, WordType _rawPattern)
+    {
+        const __m128i pattern = _mm_set1_epi32(_rawPattern);
+        std::size_t pos = _begin;
+        for (; pos + 16 <= _end; pos += 16) // 16 words at once
+        {
+            const __m128i *p = reinterpret_cast<const __m128i *>(_raw + pos);
+            __m128i eq0 = _mm_cmpeq_epi32(_mm_loadu_si128(p + 0), pattern);
+            __m128i eq1 = _mm_cmpeq_epi32(_mm_loadu_si128(p + 1), pattern);
+            __m128i eq2 = _mm_cmpeq_epi32(_mm_loadu_si128(p + 2), pattern);
+            __m128i eq3 = _mm_cmpeq_epi32(_mm_loadu_si128(p + 3), pattern);
+            __m128i any = _mm_or_si128(_mm_or_si128(eq0, eq1), _mm_or_si128(eq2, eq3));
+            if (_mm_movemask_epi8(any) == 0)
+                continue;
+            unsigned int mask = _mm_movemask_ps(_mm_castsi128_ps(eq0)) |
+                                (_mm_movemask_ps(_mm_castsi128_ps(eq1)) << 4) |
+                                (_mm_movemask_ps(_mm_castsi128_ps(eq2)) << 8) |
+                                (_mm_movemask_ps(_mm_castsi128_ps(eq3)) << 12);
+            return pos + __builtin_ctz(mask);
+        }
+        return FindRawWordScalar(_raw, pos, _end, _rawPattern);
+    }
+
+    __attribute__((target("avx2"))) static std::size_t FindRawWordAVX2(const WordType *_raw, std::size_t _begin, std::size_t _end, WordType _rawPattern)
+    {
+        const __m256i pattern = _mm256_set1_epi32(_rawPattern);
+        std::size_t pos = _begin;
+        for (; pos + 16 <= _end; pos += 16) // 16 words at once
+        {
+            const __m256i *p = reinterpret_cast<const __m256i *>(_raw + pos);
+            __m256i eq0 = _mm256_cmpeq_epi32(_mm256_loadu_si256(p + 0), pattern);
+            __m256i eq1 = _mm256_cmpeq_epi32(_mm256_loadu_si256(p + 1), pattern);
+            if (_mm256_testz_si256(_mm256_or_si256(eq0, eq1), _mm256_or_si256(eq0, eq1)))
+                continue;
+            unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq0)) |
+                                (_mm256_movemask_ps(_mm256_castsi256_ps(eq1)) << 8);
+            return pos + __builtin_ctz(mask);
+        }
+        return FindRawWordScalar(_raw, pos, _end, _rawPattern);
+    }
+#endif
+
+    using FindRawWordKernel = std::size_t (*)(const WordType *, std::size_t, std::size_t, WordType);
+
+    // The kernel is selected once, depending on the CPU.
+    static FindRawWordKernel GetFindRawWordKernel()
+    {
+        static const FindRawWordKernel kernel = []() -> FindRawWordKernel
+        {
+#ifdef MAIKO2DECODER_X86_KERNELS
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return FindRawWordAVX2;
+            return FindRawWordSSE2;
+#else
+            return FindRawWordScalar;
+#endif
+        }();
+        return kernel;
+    }
+
+    std::size_t FindRawWord(const WordType *_raw, std::size_t _begin, std::size_t _end, WordType _rawPattern)
+    {
+        return GetFindRawWordKernel()(_raw, _begin, _end, _rawPattern);
+    }
+
+    std::size_t FindFirstEventHeader(const WordType *_raw, std::size_t _nWords)
+    {
+        auto pos = FindRawWord(_raw, 0, _nWords, RawEventHeader);
+        return (pos == _nWords) ? NoWordPosition : pos;
+    }
+
+    std::size_t FindEventEnd(const WordType *_raw, std::size_t _nWords, std::size_t _posHeader)
+    {
+        std::size_t pos = _posHeader + 1;
+        while (true)
+        {
+            pos = FindRawWord(_raw, pos, _nWords, RawEventFooter);
+            if (pos == _nWords) // No event footer till the end
+                return NoWordPosition;
+            else if (pos + 1 == _nWords ||            // It is the last event
+                     _raw[pos + 1] == RawEventHeader) // Events continue in the file
+                return pos + 1;
+            ++pos; // NOT a event footer (TPC data ?) -> proceed with searching event footer
+        }
+    }
+
+    std::size_t FindNextEventHeader(const WordType *_raw, std::size_t _nWords, std::size_t _pos)
+    {
+        std::size_t pos = _pos - 1; // The footer of the previous event
+        while (true)
+        {
+            pos = FindRawWord(_raw, pos, _nWords, RawEventFooter);
+            if (pos + 1 >= _nWords) // No event follows
+                return NoWordPosition;
+            if (_raw[pos + 1] == RawEventHeader)
+                return pos + 1;
+            ++pos;
+        }
+    }
+
+    void FindEventBoundaries(const WordType *_raw, std::size_t _nWords, std::size_t _begin, std::size_t _end,
+                             std::vector<std::size_t> &_boundaries)
+    {
+        std::size_t pos = _begin;
+        while (true)
+        {
+            pos = FindRawWord(_raw, pos, _end, RawEventFooter);
+            if (pos == _end)
+                return;
+            if (pos + 1 == _nWords || _raw[pos + 1] == RawEventHeader)
+                _boundaries.push_back(pos + 1);
+            ++pos;
+        }
+    }
+}
\ No newline at end of file
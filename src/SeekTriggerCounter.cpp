@@ -0,0 +1,78 @@
+#include "StreamRawData.hpp"
+#include "DecoderFormat.hpp"
+#include "MappedFile.hpp"
+#include "RawWordsFraming.hpp"
+
+namespace MAIKo2Decoder
+{
+    // Bisect _raw[0, _nWords) for the first event with a trigger counter >= _triggerCounter.
+    static SeekTriggerCounterResult BisectTriggerCounter(const WordType *_raw, std::size_t _nWords, uint32_t _triggerCounter)
+    {
+        SeekTriggerCounterResult result;
+        const std::size_t posFirstHeader = FindFirstEventHeader(_raw, _nWords);
+        if (posFirstHeader == NoWordPosition)
+        {
+            result.noEventFound = true;
+            return result;
+        }
+
+        // The first event header at or after _pos
+        auto nextHeader = [_raw, _nWords, posFirstHeader](std::size_t _pos)
+        {
+            if (_pos <= posFirstHeader)
+                return posFirstHeader;
+            auto pos = FindNextEventHeader(_raw, _nWords, _pos);
+            return (pos == NoWordPosition) ? _nWords : pos;
+        };
+        // Trigger counter is the first counter word next to the header. An event cut before it is regarded as the last.
+        auto isReadable = [_nWords](std::size_t _posHeader)
+        { return _posHeader + LengthOfCounterWords < _nWords; };
+        auto triggerCounterAt = [_raw](std::size_t _posHeader)
+        { return SwapWordBytes(_raw[_posHeader + 1]); };
+
+        // Events beginning before lo have smaller trigger counters. The event at hi (or the end) has _triggerCounter or larger.
+        std::size_t lo = posFirstHeader;
+        std::size_t hi = _nWords;
+        while (lo < hi)
+        {
+            std::size_t pos = nextHeader(lo + (hi - lo) / 2);
+            if (pos >= hi) // No event begins in the latter half
+            {
+                pos = nextHeader(lo);
+                if (pos >= hi)
+                    break;
+            }
+
+            ++result.number_of_probes;
+            if (isReadable(pos) && triggerCounterAt(pos) < _triggerCounter)
+                lo = pos + 1;
+            else
+                hi = pos;
+        }
+
+        result.event_data_address = hi * sizeof(WordType);
+        if (hi == _nWords || !isReadable(hi))
+            return result;
+        result.event_trigger_counter = triggerCounterAt(hi);
+        const std::size_t posEnd = FindEventEnd(_raw, _nWords, hi);
+        if (posEnd != NoWordPosition)
+            result.event_data_length = (posEnd - hi) * sizeof(WordType);
+        result.goodFlag = (result.event_trigger_counter == _triggerCounter && posEnd != NoWordPosition);
+        return result;
+    }
+
+    SeekTriggerCounterResult SeekTriggerCounter(const std::string &_fileName, uint32_t _triggerCounter)
+    {
+        MappedFile file(_fileName);
+        if (!file.IsGood())
+        {
+            SeekTriggerCounterResult result;
+            result.fileNotFound = true;
+            return result;
+        }
+        file.AdviseRandom();
+        // Trailing bytes shorter than a word are ignored.
+        return BisectTriggerCounter(reinterpret_cast<const WordType *>(file.GetData()),
+                                    file.GetSize() / sizeof(WordType), _triggerCounter);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "SidecarIndex.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+
+#include "FileFingerprint.hpp"
+
+namespace MAIKo2Decoder
+{
+    std::string GetSidecarIndexPath(const std::string &_rawFilePath)
+    {
+        return _rawFilePath + ".idx";
+    }
+
+    bool WriteSidecarIndex(const std::string &_path, const std::vector<RawEventsRecord> &_records, uint64_t _rawFileSize)
+    {
+        std::vector<SidecarIndexRecord> records(_records.size());
+        for (std::size_t i = 0; i < _records.size(); ++i)
+        {
+            const auto &rec = _records[i];
+            records[i] = SidecarIndexRecord{rec.event_id, rec.event_data_address, rec.event_data_length,
+                                            rec.event_fadc_words_offset, rec.event_tpc_words_offset,
+                                            rec.event_clock_counter, rec.event_trigger_counter, 0};
+        }
+        std::stable_sort(records.begin(), records.end(),
+                         [](const SidecarIndexRecord &_lhs, const SidecarIndexRecord &_rhs)
+                         {
+                             return (_lhs.event_trigger_counter != _rhs.event_trigger_counter)
+                                        ? _lhs.event_trigger_counter < _rhs.event_trigger_counter
+                                        : _lhs.event_id < _rhs.event_id;
+                         });
+
+        SidecarIndexHeader header;
+        std::memcpy(header.magic, SidecarIndexHeader::Magic, sizeof(header.magic));
+        header.version = SidecarIndexHeader::Version;
+        header.record_size = sizeof(SidecarIndexRecord);
+        header.number_of_records = records.size();
+        header.raw_file_size = _rawFileSize;
+        header.checksum = HashBytesFNV1a(records.data(), records.size() * sizeof(SidecarIndexRecord));
+        header.reserved = 0;
+
+        const std::string tmpPath = _path + ".tmp";
+        {
+            std::ofstream fOut(tmpPath, std::ios::binary | std::ios::trunc);
+            fOut.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            fOut.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(SidecarIndexRecord));
+            if (!fOut.good())
+            {
+                fOut.close();
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+        }
+        return std::rename(tmpPath.c_str(), _path.c_str()) == 0;
+    }
+
+    SidecarIndex::SidecarIndex(const std::string &_path)
+        : fGood(false), fFile(_path), fHeader(nullptr), fRecords(nullptr)
+    {
+        if (!fFile.IsGood() || fFile.GetSize() < sizeof(SidecarIndexHeader))
+            return;
+
+        const auto *header = reinterpret_cast<const SidecarIndexHeader *>(fFile.GetData());
+        if (std::memcmp(header->magic, SidecarIndexHeader::Magic, sizeof(header->magic)) != 0 ||
+            header->version != SidecarIndexHeader::Version ||
+            header->record_size != sizeof(SidecarIndexRecord) ||
+            fFile.GetSize() != sizeof(SidecarIndexHeader) + header->number_of_records * sizeof(SidecarIndexRecord))
+            return;
+
+        // Records begin right after the header, aligned to 8 bytes on the page-aligned mapping.
+        const auto *records = reinterpret_cast<const SidecarIndexRecord *>(fFile.GetData() + sizeof(SidecarIndexHeader));
+        if (HashBytesFNV1a(records, header->number_of_records * sizeof(SidecarIndexRecord)) != header->checksum)
+            return;
+
+        fGood = true;
+        fHeader = header;
+        fRecords = records;
+    }
+
+    std::pair<const SidecarIndexRecord *, const SidecarIndexRecord *> SidecarIndex::FindByTriggerCounter(uint32_t _triggerCounter) const
+    {
+        struct CompareTriggerCounter
+        {
+            bool operator()(const SidecarIndexRecord &_rec, uint32_t _value) const { return _rec.event_trigger_counter < _value; }
+            bool operator()(uint32_t _value, const SidecarIndexRecord &_rec) const { return _value < _rec.event_trigger_counter; }
+        };
+        return std::equal_range(begin(), end(), _triggerCounter, CompareTriggerCounter());
+    }
+
+    std::vector<RawEventsRecord> SidecarIndex::GetRecordsInEventOrder(uint32_t _runId, uint32_t _planeId, uint32_t _boardId, uint32_t _fileNumber) const
+    {
+        std::vector<RawEventsRecord> records;
+        records.reserve(GetNumberOfRecords());
+        for (const auto &rec : *this)
+        {
+            records.push_back(RawEventsRecord{_runId, _planeId, _boardId, _fileNumber, rec.event_id,
+                                              rec.event_data_address, rec.event_data_length,
+                                              rec.event_fadc_words_offset, rec.event_tpc_words_offset,
+                                              rec.event_clock_counter, rec.event_trigger_counter});
+        }
+        std::sort(records.begin(), records.end(),
+                  [](const RawEventsRecord &_lhs, const RawEventsRecord &_rhs)
+                  { return _lhs.event_id < _rhs.event_id; });
+        return records;
+    }
+}
\ No newline at end of file
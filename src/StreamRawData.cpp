@@ -1,109 +1,196 @@
 #include "StreamRawData.hpp"
 #include <fstream>
+#include <chrono>
+#include <utility>
 #include "DecoderUtility.hpp"
 #include "DecoderFormat.hpp"
+#include "MappedFile.hpp"
+#include "RawWordsFraming.hpp"
 
 namespace MAIKo2Decoder
 {
+    // Source of raw words read from the file with std::ifstream, block by block.
+    // Each byte in the file is read only once.
+    class IFStreamWordsSource
+    {
+    public:
+        // Begin reading at _startWord
+        IFStreamWordsSource(std::ifstream &_fIn, uint64_t _startWord)
+            : fIn(_fIn), fBlock(NumberOfWordsInBlock), fBlockSize(0), fBlockAddress(_startWord)
+        {
+            fIn.seekg(_startWord * sizeof(WordType));
+        }
 
-    StreamRawDataResult StreamRawData(StreamRawDataInput _input,
-                                      std::function<bool(const RawEventData &)> _callBack)
+        const WordType *GetBlock() const { return fBlock.data(); }
+        std::size_t GetBlockSize() const { return fBlockSize; }
+        uint64_t GetBlockAddress() const { return fBlockAddress; } // in words
+
+        // Read the next block. Return false if no word is left in the file.
+        bool NextBlock()
+        {
+            fBlockAddress += fBlockSize;
+            fIn.read(reinterpret_cast<char *>(fBlock.data()), fBlock.size() * sizeof(WordType));
+            fBlockSize = fIn.gcount() / sizeof(WordType); // Trailing bytes shorter than a word are ignored.
+            return fBlockSize > 0;
+        }
+
+    private:
+        inline static const std::size_t NumberOfWordsInBlock = 1 << 18; // 1 MiB
+        std::ifstream &fIn;
+        std::vector<WordType> fBlock;
+        std::size_t fBlockSize;
+        uint64_t fBlockAddress;
+    };
+
+    // Source of raw words on the memory-mapped file. The whole file is a single block.
+    class MappedWordsSource
+    {
+    public:
+        // Begin at _startWord
+        MappedWordsSource(const MappedFile &_file, uint64_t _startWord)
+            : fFile(_file), fStartWord(_startWord), fBlockSize(0), fConsumed(false) {}
+
+        const WordType *GetBlock() const { return reinterpret_cast<const WordType *>(fFile.GetData()) + fStartWord; }
+        std::size_t GetBlockSize() const { return fBlockSize; }
+        uint64_t GetBlockAddress() const { return fStartWord; }
+
+        bool NextBlock()
+        {
+            if (fConsumed)
+            {
+                fBlockSize = 0;
+                return false;
+            }
+            fConsumed = true;
+            // Trailing bytes shorter than a word are ignored.
+            const uint64_t nWords = fFile.GetSize() / sizeof(WordType);
+            fBlockSize = (nWords > fStartWord) ? nWords - fStartWord : 0;
+            return fBlockSize > 0;
+        }
+
+    private:
+        const MappedFile &fFile;
+        const uint64_t fStartWord;
+        std::size_t fBlockSize;
+        bool fConsumed;
+    };
+
+    // Append byte-order corrected _raw[_begin, _end) to _words.
+    static void AppendRawWords(std::vector<WordType> &_words, const WordType *_raw, std::size_t _begin, std::size_t _end)
+    {
+        auto nWordsBefore = _words.size();
+        _words.resize(nWordsBefore + (_end - _begin));
+        CorrectRawWords(_raw + _begin, _words.data() + nWordsBefore, _end - _begin);
+    }
+
+    // Frame events in a single pass over the raw words given by _source.
+    // Words are copied into the event buffer while searching for the event footer,
+    // so that each word is read and byte-swapped exactly once.
+    template <typename Source>
+    static StreamRawDataResult FrameEvents(const StreamRawDataInput &_input, Source &_source,
+                                           const std::function<bool(const RawEventData &)> &_callBack)
     {
         StreamRawDataResult result;
         result.input = _input;
-        std::ifstream fIn(_input.fileName, std::ios::binary);
+        result.number_of_bytes_processed = _input.start_address;
 
-        if (!fIn.good())
+        // Seek header of 1st event
+        std::size_t pos = 0; // Position in the current block
+        if (!_source.NextBlock())
         {
-            result.fileNotFound = true;
+            result.noEventFound = true;
+            return result;
+        }
+        if (_input.start_address != 0 && _source.GetBlock()[0] != RawEventHeader) // Must resume at an event
+        {
+            result.invalidHeader = true;
             return result;
         }
-
-        // Seek header of 1st event
         while (true)
         {
-            if (!fIn.good())
+            pos = FindRawWord(_source.GetBlock(), 0, _source.GetBlockSize(), RawEventHeader);
+            if (pos < _source.GetBlockSize()) // 1 st event is found
+                break;
+            if (!_source.NextBlock())
             {
                 result.noEventFound = true;
                 return result;
             }
-
-            MAIKo2Decoder::WordType word = MAIKo2Decoder::ReadNextWord(fIn);
-            if (word == MAIKo2Decoder::EventHeader) // 1 st event is found
-            {
-                fIn.seekg(-sizeof(MAIKo2Decoder::WordType), std::ios_base::cur); // back to the position of the header
-                break;
-            }
         }
 
-        while (true)
+        std::vector<WordType> wordsEvent;
+        bool endOfFile = false;
+        while (!endOfFile)
         {
-            RawEventData evt;
-            if (!fIn.good())
-            {
-                result.errorWhileSearchingEvent = true;
-                return result;
-            }
+            // pos < _source.GetBlockSize() here : the strict check below moves to the next block when an event ends
+            // at the end of a block, and the words of an event spanning blocks are gathered in the footer search.
 
-            auto posHeader = fIn.tellg();
             // Expect events begin from the header
-            MAIKo2Decoder::WordType wordHeader = MAIKo2Decoder::ReadNextWord(fIn);
-
-            if (fIn.eof())
-            {
-                break;
-            }
-            else if (wordHeader != MAIKo2Decoder::EventHeader)
+            if (_source.GetBlock()[pos] != RawEventHeader)
             {
                 result.invalidHeader = true;
                 return result;
             }
 
+            const uint64_t posHeader = _source.GetBlockAddress() + pos; // in words
+
             // Find event footer
+            std::size_t posSearch = pos + 1;
             while (true)
             {
-                auto word = MAIKo2Decoder::ReadNextWord(fIn);
-                if (word == MAIKo2Decoder::EventFooter)
+                const WordType *block = _source.GetBlock();
+                const std::size_t blockSize = _source.GetBlockSize();
+                auto posFooter = FindRawWord(block, posSearch, blockSize, RawEventFooter);
+                if (posFooter == blockSize) // Not in this block
                 {
-                    // strict check : next word must be the header or EOF
-                    auto wordNext = MAIKo2Decoder::ReadNextWord(fIn);
-                    if (wordNext == MAIKo2Decoder::EventHeader) // Events continue in the file
+                    AppendRawWords(wordsEvent, block, pos, blockSize);
+                    if (!_source.NextBlock())
                     {
-                        fIn.seekg(-sizeof(uint32_t), std::ios_base::cur); // back to the position of the header
-                        break;
+                        result.noEventFooter = true;
+                        return result;
                     }
-                    else if (fIn.eof()) // It is the last event
+                    pos = 0;
+                    posSearch = 0;
+                    continue;
+                }
+
+                AppendRawWords(wordsEvent, block, pos, posFooter + 1);
+                pos = posFooter + 1;
+
+                // strict check : next word must be the header or EOF
+                if (pos == blockSize)
+                {
+                    if (!_source.NextBlock()) // It is the last event
                     {
-                        fIn.clear(); // Release lock on the stream to keep good bit of the stream on.
+                        if (_input.growing) // Not known to be complete yet
+                        {
+                            result.noEventFooter = true;
+                            return result;
+                        }
+                        endOfFile = true;
                         break;
                     }
-                    else // NOT a event footer (TPC data ?) -> proceed with searching event footer
-                    {
-                        continue;
-                    }
-                }
-                else if (fIn.eof())
-                {
-                    result.noEventFooter = true;
-                    return result;
+                    pos = 0;
                 }
+                if (_source.GetBlock()[pos] == RawEventHeader) // Events continue in the file
+                    break;
+                posSearch = pos; // NOT a event footer (TPC data ?) -> proceed with searching event footer
             }
 
-            auto posFooter = fIn.tellg();
-
-            fIn.seekg(posHeader, std::ios_base::beg);
-            auto wordsEvent = MAIKo2Decoder::ReadNextWords(fIn, (posFooter - posHeader) / sizeof(MAIKo2Decoder::WordType));
+            RawEventData evt;
             ++result.number_of_events_processed;
-            evt.event_id = result.number_of_events_processed;
-            evt.event_data_address = posHeader;
-            evt.event_data_length = posFooter - posHeader;
-            evt.words = MAIKo2Decoder::EventWordsBuffer(wordsEvent);
+            evt.event_id = _input.first_event_id + result.number_of_events_processed - 1;
+            evt.event_data_address = posHeader * sizeof(WordType);
+            evt.event_data_length = wordsEvent.size() * sizeof(WordType);
+            evt.words = EventWordsBuffer(std::move(wordsEvent));
+            wordsEvent.clear(); // moved-from
 
             if (!evt.words.IsValid())
             {
                 result.eventFormatError = true;
                 return result;
             }
+            result.number_of_bytes_processed = evt.event_data_address + evt.event_data_length;
             auto doContinue = _callBack(evt);
             if (!doContinue)
             {
@@ -113,5 +200,57 @@ namespace MAIKo2Decoder
         }
         result.goodFlag = true;
         return result;
-    };
+    }
+
+    StreamRawDataResult StreamRawData(StreamRawDataInput _input,
+                                      std::function<bool(const RawEventData &)> _callBack)
+    {
+        auto timeBegin = std::chrono::steady_clock::now();
+
+        StreamRawDataResult result;
+        if (_input.start_address % sizeof(WordType) != 0)
+        {
+            result.input = _input;
+            result.invalidHeader = true;
+            return result;
+        }
+        const uint64_t startWord = _input.start_address / sizeof(WordType);
+        switch (_input.engine)
+        {
+        case StreamRawDataEngine::MemoryMap:
+        {
+            MappedFile file(_input.fileName);
+            if (!file.IsGood())
+            {
+                result.input = _input;
+                result.fileNotFound = true;
+                return result;
+            }
+            file.AdviseSequential();
+            MappedWordsSource source(file, startWord);
+            result = FrameEvents(_input, source, _callBack);
+            break;
+        }
+        case StreamRawDataEngine::IFStream:
+        default:
+        {
+            std::ifstream fIn(_input.fileName, std::ios::binary);
+            if (!fIn.good())
+            {
+                result.input = _input;
+                result.fileNotFound = true;
+                return result;
+            }
+            IFStreamWordsSource source(fIn, startWord);
+            result = FrameEvents(_input, source, _callBack);
+            break;
+        }
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeBegin;
+        result.elapsed_seconds = elapsed.count();
+        if (result.elapsed_seconds > 0. && result.number_of_bytes_processed > _input.start_address)
+            result.bytes_per_second = (result.number_of_bytes_processed - _input.start_address) / result.elapsed_seconds;
+        return result;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "StreamRawData.hpp"
+#include <chrono>
+#include <future>
+#include <algorithm>
+#include "DecoderUtility.hpp"
+#include "DecoderFormat.hpp"
+#include "MappedFile.hpp"
+#include "RawWordsFraming.hpp"
+
+namespace MAIKo2Decoder
+{
+    // Outcome of the events processed in a chunk
+    struct ChunkResult
+    {
+        std::size_t failedEventIndex = NoWordPosition; // index (from 0) of the first event failed in the chunk
+        bool eventFormatError = false;
+        bool abortedByCallBack = false;
+    };
+
+    // Process events [_firstEvent, _lastEvent) framed by _boundaries. Event i is given event_id _firstEventId + i.
+    static ChunkResult ProcessEventsInChunk(const WordType *_raw, const std::vector<std::size_t> &_boundaries,
+                                            std::size_t _firstEvent, std::size_t _lastEvent, uint64_t _firstEventId, unsigned int _chunkIndex,
+                                            const std::function<bool(unsigned int, const RawEventData &)> &_callBack)
+    {
+        ChunkResult result;
+        for (std::size_t iEvent = _firstEvent; iEvent < _lastEvent; ++iEvent)
+        {
+            const std::size_t posHeader = _boundaries[iEvent];
+            const std::size_t nWords = _boundaries[iEvent + 1] - posHeader;
+            std::vector<WordType> wordsEvent(nWords);
+            CorrectRawWords(_raw + posHeader, wordsEvent.data(), nWords);
+
+            RawEventData evt;
+            evt.event_id = _firstEventId + iEvent;
+            evt.event_data_address = posHeader * sizeof(WordType);
+            evt.event_data_length = nWords * sizeof(WordType);
+            evt.words = EventWordsBuffer(std::move(wordsEvent));
+
+            if (!evt.words.IsValid())
+            {
+                result.failedEventIndex = iEvent;
+                result.eventFormatError = true;
+                return result;
+            }
+            if (!_callBack(_chunkIndex, evt))
+            {
+                result.failedEventIndex = iEvent;
+                result.abortedByCallBack = true;
+                return result;
+            }
+        }
+        return result;
+    }
+
+    static StreamRawDataResult FrameEventsInParallel(const StreamRawDataInput &_input, const MappedFile &_file, unsigned int _nChunks,
+                                                     const std::function<bool(unsigned int, const RawEventData &)> &_callBack,
+                                                     const std::function<void(unsigned int, bool)> &_chunkDone)
+    {
+        StreamRawDataResult result;
+        result.input = _input;
+
+        const WordType *raw = reinterpret_cast<const WordType *>(_file.GetData());
+        const std::size_t nWords = _file.GetSize() / sizeof(WordType); // Trailing bytes shorter than a word are ignored.
+        const std::size_t posStart = _input.start_address / sizeof(WordType);
+        result.number_of_bytes_processed = _input.start_address;
+        if (posStart >= nWords)
+        {
+            result.noEventFound = true;
+            return result;
+        }
+        if (_input.start_address != 0 && raw[posStart] != RawEventHeader) // Must resume at an event
+        {
+            result.invalidHeader = true;
+            return result;
+        }
+        const std::size_t posFirstHeader = FindRawWord(raw, posStart, nWords, RawEventHeader);
+        if (posFirstHeader == nWords)
+        {
+            result.noEventFound = true;
+            return result;
+        }
+
+        // Chunks : [chunkBegins[i], chunkBegins[i + 1]) in words
+        if (_nChunks == 0)
+            _nChunks = 1;
+        std::vector<std::size_t> chunkBegins(_nChunks + 1);
+        for (unsigned int iChunk = 0; iChunk <= _nChunks; ++iChunk)
+            chunkBegins[iChunk] = posFirstHeader + (nWords - posFirstHeader) * iChunk / _nChunks;
+
+        // 1. Find event boundaries in each chunk
+        std::vector<std::future<std::vector<std::size_t>>> boundariesFuture(_nChunks);
+        for (unsigned int iChunk = 0; iChunk < _nChunks; ++iChunk)
+        {
+            boundariesFuture[iChunk] = std::async(
+                std::launch::async,
+                [raw, nWords, &chunkBegins](unsigned int _iChunk)
+                {
+                    std::vector<std::size_t> boundaries;
+                    FindEventBoundaries(raw, nWords, chunkBegins[_iChunk], chunkBegins[_iChunk + 1], boundaries);
+                    return boundaries;
+                },
+                iChunk);
+        }
+
+        // 2. Stitch them in order : event i is [boundaries[i], boundaries[i + 1])
+        std::vector<std::size_t> boundaries{posFirstHeader};
+        std::vector<std::size_t> firstEventOfChunk(_nChunks + 1);
+        for (unsigned int iChunk = 0; iChunk < _nChunks; ++iChunk)
+        {
+            firstEventOfChunk[iChunk] = boundaries.size() - 1;
+            auto boundariesInChunk = boundariesFuture[iChunk].get();
+            boundaries.insert(boundaries.end(), boundariesInChunk.begin(), boundariesInChunk.end());
+        }
+        if (_input.growing && boundaries.size() > 1 && boundaries.back() == nWords) // The event at the end may not be complete
+        {
+            boundaries.pop_back();
+            for (auto &firstEvent : firstEventOfChunk)
+                firstEvent = std::min(firstEvent, boundaries.size() - 1);
+        }
+        const std::size_t nEvents = boundaries.size() - 1;
+        firstEventOfChunk[_nChunks] = nEvents;
+
+        // 3. Process events in each chunk
+        std::vector<std::future<ChunkResult>> chunkResultsFuture(_nChunks);
+        for (unsigned int iChunk = 0; iChunk < _nChunks; ++iChunk)
+        {
+            chunkResultsFuture[iChunk] = std::async(
+                std::launch::async,
+                [raw, &boundaries, &firstEventOfChunk, &_input, &_callBack, &_chunkDone](unsigned int _iChunk)
+                {
+                    auto chunkResult = ProcessEventsInChunk(raw, boundaries,
+                                                            firstEventOfChunk[_iChunk], firstEventOfChunk[_iChunk + 1],
+                                                            _input.first_event_id, _iChunk, _callBack);
+                    if (_chunkDone)
+                        _chunkDone(_iChunk, chunkResult.failedEventIndex != NoWordPosition);
+                    return chunkResult;
+                },
+                iChunk);
+        }
+
+        // The first failure in the file decides the result, as StreamRawData() stops there.
+        ChunkResult firstFailure;
+        for (auto &chunkResultFuture : chunkResultsFuture)
+        {
+            auto chunkResult = chunkResultFuture.get();
+            if (firstFailure.failedEventIndex == NoWordPosition && chunkResult.failedEventIndex != NoWordPosition)
+                firstFailure = chunkResult;
+        }
+
+        if (firstFailure.failedEventIndex != NoWordPosition)
+        {
+            const std::size_t iEvent = firstFailure.failedEventIndex;
+            result.number_of_events_processed = iEvent + 1;
+            if (firstFailure.eventFormatError)
+            {
+                // Up to the end of the previous event
+                result.eventFormatError = true;
+                if (iEvent > 0)
+                    result.number_of_bytes_processed = boundaries[iEvent] * sizeof(WordType);
+            }
+            else
+            {
+                // Up to the end of the event rejected by _callBack
+                result.abortedByCallBack = true;
+                result.number_of_bytes_processed = boundaries[iEvent + 1] * sizeof(WordType);
+            }
+            return result;
+        }
+
+        result.number_of_events_processed = nEvents;
+        if (nEvents > 0)
+            result.number_of_bytes_processed = boundaries.back() * sizeof(WordType);
+        if (boundaries.back() != nWords) // The last event is not terminated
+        {
+            result.noEventFooter = true;
+            return result;
+        }
+        result.goodFlag = true;
+        return result;
+    }
+
+    StreamRawDataResult StreamRawDataInParallel(StreamRawDataInput _input, unsigned int _nChunks,
+                                                std::function<bool(unsigned int, const RawEventData &)> _callBack,
+                                                std::function<void(unsigned int, bool)> _chunkDone)
+    {
+        auto timeBegin = std::chrono::steady_clock::now();
+
+        if (_input.start_address % sizeof(WordType) != 0)
+        {
+            StreamRawDataResult result;
+            result.input = _input;
+            result.invalidHeader = true;
+            return result;
+        }
+        MappedFile file(_input.fileName);
+        if (!file.IsGood())
+        {
+            StreamRawDataResult result;
+            result.input = _input;
+            result.fileNotFound = true;
+            return result;
+        }
+        auto result = FrameEventsInParallel(_input, file, _nChunks, _callBack, _chunkDone);
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timeBegin;
+        result.elapsed_seconds = elapsed.count();
+        if (result.elapsed_seconds > 0. && result.number_of_bytes_processed > _input.start_address)
+            result.bytes_per_second = (result.number_of_bytes_processed - _input.start_address) / result.elapsed_seconds;
+        return result;
+    }
+}
\ No newline at end of file
@@ -1,11 +1,12 @@
 #include "TPCData.hpp"
+#include <utility>
 #include <array>
 #include <sstream>
 
 namespace MAIKo2Decoder
 {
-    TPCData::TPCData(const std::vector<WordType> &_words)
-        : fGood(false), fEmpty(false)
+    TPCData::TPCData(WordsView _words)
+        : fGood(false), fEmpty(false), fNumberOfHits(0)
     {
         if (_words.size() == 0)
         {
@@ -13,6 +14,16 @@ namespace MAIKo2Decoder
         }
         else if (_words.size() % 5 == 0)
         {
+            // Pre-pass : count clocks with hits to allocate the bitmap at once
+            std::size_t nClocksHit = 0;
+            for (auto it = _words.begin(); it != _words.end(); it = it + 5)
+            {
+                if (CheckHeaderFormat(*it) &&
+                    (*(it + 1) | *(it + 2) | *(it + 3) | *(it + 4)) != 0)
+                    ++nClocksHit;
+            }
+            fOccupancy.reserve(nClocksHit);
+
             for (auto it = _words.begin(); it != _words.end(); it = it + 5)
             {
                 WordType headerWord = *it;
@@ -29,67 +40,31 @@ namespace MAIKo2Decoder
 
                 if (CheckHeaderFormat(headerWord))
                 {
-                    auto clock = GetClock(headerWord);
-
-                    // // 32 bit (8 is number of bits in char type variable)
-                    // const auto nBitsWord = sizeof(words.at(0)) * 8;
-                    // for (unsigned int iWord = 0; iWord < words.size(); ++iWord)
-                    // {
-                    //     // shift 32 strips for each words
-                    //     const unsigned int stripShift = iWord * nBitsWord;
-                    //     auto word = words.at(iWord);
-                    //     for (unsigned int iBit = 0; iBit < nBitsWord; ++iBit)
-                    //     {
-                    //         const unsigned int stripInner = iBit;
-                    //         // Position of the bit. Count from the most significant bit.
-                    //         const unsigned int bitShift = iBit;
-                    //         if (word & (0x80000000 >> (bitShift)))
-                    //         {
-                    //             fTPCHits.push_back(Hit(stripInner + stripShift, clock));
-                    //         }
-                    //     }
-                    // }
+                    if ((words[0] | words[1] | words[2] | words[3]) == 0) // No hit in this clock
+                        continue;
 
-                    // 32 bit (8 is number of bits in char type variable)
-                    const auto nBitsWord = sizeof(words.at(0)) * 8;
+                    ClockOccupancy occupancy;
+                    occupancy.clock = GetClock(headerWord);
+                    // strips.at(k) : strip 32 * k -- 32 * k + 31
                     for (unsigned int iWord = 0; iWord < words.size(); ++iWord)
                     {
-                        // shift 32 strips for each words
-                        const unsigned int stripShift = (words.size() - 1 - iWord) * nBitsWord;
-                        auto word = words.at(iWord);
-                        // iBit : Position of the bit. Count from the least significant bit.
-                        for (unsigned int iBit = 0; iBit < nBitsWord; ++iBit)
-                        {
-                            const unsigned int stripInner = iBit;
-                            if (word & (0x00000001 << (iBit)))
-                            {
-                                fTPCHits.push_back(Hit(stripInner + stripShift, clock));
-                            }
-                        }
+                        occupancy.strips[words.size() - 1 - iWord] = words[iWord];
+                        fNumberOfHits += CountSetBits(words[iWord]);
                     }
+                    fOccupancy.push_back(occupancy);
                 }
                 else
                 {
-                    std::ostringstream tmpErrorLog;
-                    tmpErrorLog << "Format error in " << (it - _words.begin()) / 5 << " th clock " << std::endl;
-                    tmpErrorLog << "    Header " << std::hex << headerWord << ", "
-                                << "Format " << (0xffff0000 & headerWord) << " (== 0x80000000?), " << std::dec << std::endl;
-                    tmpErrorLog << "    word1 " << std::dec << words.at(0) << std::dec << std::endl;
-                    tmpErrorLog << "    word2 " << std::dec << words.at(1) << std::dec << std::endl;
-                    tmpErrorLog << "    word3 " << std::dec << words.at(2) << std::dec << std::endl;
-                    tmpErrorLog << "    word4 " << std::dec << words.at(3) << std::dec << std::endl;
-                    fErrorLog += tmpErrorLog.str();
+                    fErrors.Add(DecodeErrorCode::TPCClockHeaderFormat, (it - _words.begin()) / 5, it, 5);
                 }
             }
         }
         else
         {
-            std::ostringstream tmpErrorLog;
-            tmpErrorLog << "Format error: The length of TPC data must be 5n, but that of this event is " << _words.size() << std::endl;
-            fErrorLog += tmpErrorLog.str();
+            fErrors.Add(DecodeErrorCode::TPCLengthNotMultipleOf5, _words.size());
         }
-        // Check Validity (No error log?)
-        if (fErrorLog == "")
+        // Check Validity (No error?)
+        if (fErrors.IsEmpty())
         {
             fGood = true;
         }
@@ -99,16 +74,91 @@ namespace MAIKo2Decoder
         }
     }
 
+    std::vector<TPCData::Hit> TPCData::GetHits() const
+    {
+        std::vector<Hit> hits;
+        AppendHits(hits);
+        return hits;
+    }
+
+    void TPCData::AppendHits(std::vector<Hit> &_hits) const
+    {
+        _hits.reserve(_hits.size() + fNumberOfHits);
+        for (const auto &occupancy : fOccupancy)
+        {
+            // The same strip order as the raw data : strip 127 -- 096, 095 -- 064, ...
+            for (unsigned int iWord = occupancy.strips.size(); iWord-- > 0;)
+            {
+                const unsigned int stripShift = iWord * 32;
+                // Jump from a set bit to the next one, from the least significant bit.
+                for (auto word = occupancy.strips[iWord]; word != 0; word &= word - 1)
+                    _hits.emplace_back(stripShift + CountTrailingZeros(word), occupancy.clock);
+            }
+        }
+    }
+
+    bool TPCData::CheckStructure(WordsView _words)
+    {
+        if (_words.size() % 5 != 0)
+            return false;
+        for (auto it = _words.begin(); it != _words.end(); it = it + 5)
+        {
+            if (!CheckHeaderFormat(*it))
+                return false;
+        }
+        return true;
+    }
+
+    std::string TPCData::GetErrorLog() const
+    {
+        std::ostringstream tmpErrorLog;
+        for (const auto &error : fErrors.GetErrors())
+        {
+            if (error.code == DecodeErrorCode::TPCLengthNotMultipleOf5)
+            {
+                tmpErrorLog << "Format error: The length of TPC data must be 5n, but that of this event is " << error.offset << std::endl;
+                continue;
+            }
+
+            WordType headerWord = error.words[0];
+            tmpErrorLog << "Format error in " << error.offset << " th clock " << std::endl;
+            tmpErrorLog << "    Header " << std::hex << headerWord << ", "
+                        << "Format " << (0xffff0000 & headerWord) << " (== 0x80000000?), " << std::dec << std::endl;
+            tmpErrorLog << "    word1 " << std::dec << error.words[1] << std::dec << std::endl;
+            tmpErrorLog << "    word2 " << std::dec << error.words[2] << std::dec << std::endl;
+            tmpErrorLog << "    word3 " << std::dec << error.words[3] << std::dec << std::endl;
+            tmpErrorLog << "    word4 " << std::dec << error.words[4] << std::dec << std::endl;
+        }
+        if (fErrors.IsTruncated())
+            tmpErrorLog << "... and " << fErrors.GetNumberOfErrors() - fErrors.GetErrors().size() << " more errors" << std::endl;
+        return tmpErrorLog.str();
+    }
+
     TPCData::TPCData(const TPCData &_rhs)
-        : fGood(_rhs.fGood), fEmpty(_rhs.fEmpty), fTPCHits(_rhs.fTPCHits),
-          fErrorLog(_rhs.fErrorLog){};
+        : fGood(_rhs.fGood), fEmpty(_rhs.fEmpty), fNumberOfHits(_rhs.fNumberOfHits),
+          fOccupancy(_rhs.fOccupancy), fErrors(_rhs.fErrors){};
 
     TPCData &TPCData::operator=(const TPCData &_rhs)
     {
         fGood = _rhs.fGood;
         fEmpty = _rhs.fEmpty;
-        fTPCHits = _rhs.fTPCHits;
-        fErrorLog = _rhs.fErrorLog;
+        fNumberOfHits = _rhs.fNumberOfHits;
+        fOccupancy = _rhs.fOccupancy;
+        fErrors = _rhs.fErrors;
+        return *this;
+    }
+
+    TPCData::TPCData(TPCData &&_rhs) noexcept
+        : fGood(_rhs.fGood), fEmpty(_rhs.fEmpty), fNumberOfHits(_rhs.fNumberOfHits),
+          fOccupancy(std::move(_rhs.fOccupancy)), fErrors(std::move(_rhs.fErrors)){};
+
+    TPCData &TPCData::operator=(TPCData &&_rhs) noexcept
+    {
+        fGood = _rhs.fGood;
+        fEmpty = _rhs.fEmpty;
+        fNumberOfHits = _rhs.fNumberOfHits;
+        fOccupancy = std::move(_rhs.fOccupancy);
+        fErrors = std::move(_rhs.fErrors);
         return *this;
     }
 }
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "WorkStealingPool.hpp"
+
+namespace MAIKo2Decoder
+{
+    // The pool and the queue of the worker running on this thread (nullptr outside of workers)
+    static thread_local WorkStealingPool *tCurrentPool = nullptr;
+    static thread_local unsigned int tCurrentIndex = 0;
+
+    WorkStealingPool::WorkStealingPool(unsigned int _nThreads)
+        : fNumberOfQueuedTasks(0), fStop(false), fNextQueue(0), fNumberOfSteals(0)
+    {
+        if (_nThreads == 0)
+            _nThreads = std::thread::hardware_concurrency();
+        if (_nThreads == 0) // Not detectable
+            _nThreads = 1;
+
+        for (unsigned int i = 0; i < _nThreads; ++i)
+            fQueues.push_back(std::make_unique<WorkerQueue>());
+        for (unsigned int i = 0; i < _nThreads; ++i)
+            fThreads.emplace_back(&WorkStealingPool::Run, this, i);
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fStop = true;
+        }
+        fCondition.notify_all();
+        for (auto &thread : fThreads)
+            thread.join();
+    }
+
+    void WorkStealingPool::Push(std::function<void()> _task)
+    {
+        const unsigned int index = (tCurrentPool == this) ? tCurrentIndex
+                                                          : fNextQueue++ % fQueues.size();
+        // Counted before queued so that the count never falls below the number of tasks in the queues
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            ++fNumberOfQueuedTasks;
+        }
+        {
+            std::lock_guard<std::mutex> lock(fQueues[index]->mutex);
+            fQueues[index]->tasks.push_back(std::move(_task));
+        }
+        fCondition.notify_one();
+    }
+
+    bool WorkStealingPool::TryPop(unsigned int _index, std::function<void()> &_task)
+    {
+        // Own queue : the newest task
+        {
+            std::lock_guard<std::mutex> lock(fQueues[_index]->mutex);
+            if (!fQueues[_index]->tasks.empty())
+            {
+                _task = std::move(fQueues[_index]->tasks.back());
+                fQueues[_index]->tasks.pop_back();
+                return true;
+            }
+        }
+        // Other queues : the oldest task
+        for (std::size_t i = 1; i < fQueues.size(); ++i)
+        {
+            auto &queue = *fQueues[(_index + i) % fQueues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                _task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                ++fNumberOfSteals;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingPool::Run(unsigned int _index)
+    {
+        tCurrentPool = this;
+        tCurrentIndex = _index;
+        while (true)
+        {
+            std::function<void()> task;
+            if (TryPop(_index, task))
+            {
+                {
+                    std::lock_guard<std::mutex> lock(fMutex);
+                    --fNumberOfQueuedTasks;
+                }
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(fMutex);
+            fCondition.wait(lock, [this]()
+                            { return fNumberOfQueuedTasks > 0 || fStop; });
+            if (fNumberOfQueuedTasks == 0 && fStop)
+                return;
+        }
+    }
+}
\ No newline at end of file
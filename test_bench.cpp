@@ -21,6 +21,11 @@
 #include "EventWordsBuffer.hpp"
 #include "StreamRawData.hpp"
 #include "IndexTableFormat.hpp"
+#include "SidecarIndex.hpp"
+#include "BuiltEventData.hpp"
+#include "BuiltEventFile.hpp"
+#include "BatchedEventReader.hpp"
+#include "EventIndexQuery.hpp"
 
 template <typename T>
 std::string MakeAA(const std::vector<T> &_vals,
@@ -112,370 +117,240 @@ struct ResultsOfThread
     std::vector<MAIKo2Decoder::RawFilesRecord> files;
 };
 
-struct EventIndex
+std::string DumpFragmentLocation(const MAIKo2Decoder::FragmentLocation &_loc)
 {
-    uint32_t run_id;
-    uint32_t plane_id;
-    uint32_t board_id;
-    std::string file_path;
-    uint64_t event_data_address;
-    uint32_t event_data_length;
-    uint32_t event_fadc_words_offset;
-    uint32_t event_tpc_words_offset;
-
-    std::string Dump() const
-    {
-        std::ostringstream tmp;
-        tmp << "run_id                  : " << run_id << std::endl;
-        tmp << "plane_id                : " << plane_id << std::endl;
-        tmp << "board_id                : " << board_id << std::endl;
-        tmp << "file_path               : " << file_path << std::endl;
-        tmp << "event_data_address      : " << event_data_address << std::endl;
-        tmp << "event_data_length       : " << event_data_length << std::endl;
-        tmp << "event_fadc_words_offset : " << event_fadc_words_offset << std::endl;
-        tmp << "event_tpc_words_offset  : " << event_tpc_words_offset << std::endl;
-
-        return tmp.str();
-    }
-};
+    std::ostringstream tmp;
+    tmp << "run_id                  : " << _loc.run_id << std::endl;
+    tmp << "plane_id                : " << _loc.plane_id << std::endl;
+    tmp << "board_id                : " << _loc.board_id << std::endl;
+    tmp << "file_path               : " << _loc.file_path << std::endl;
+    tmp << "event_data_address      : " << _loc.event_data_address << std::endl;
+    tmp << "event_data_length       : " << _loc.event_data_length << std::endl;
+    tmp << "event_fadc_words_offset : " << _loc.event_fadc_words_offset << std::endl;
+    tmp << "event_tpc_words_offset  : " << _loc.event_tpc_words_offset << std::endl;
 
-struct FragmentedEventData
-{
-    uint32_t run_id;
-    uint32_t plane_id;
-    uint32_t board_id;
-    uint32_t event_number;
-    MAIKo2Decoder::CounterData counter;
-    MAIKo2Decoder::FADCData fadc;
-    MAIKo2Decoder::TPCData tpc;
-};
+    return tmp.str();
+}
 
-class BuiltEventData
+int main(int argc, char *argv[])
 {
-public:
-    using Hit = MAIKo2Decoder::TPCData::Hit;
-    using ShortWordType = MAIKo2Decoder::FADCData::ShortWordType;
-
-    BuiltEventData()
-        : fHitMapper([](uint32_t _plane_id, uint32_t _board_id, Hit _hit) -> Hit
-                     { return {_hit.strip + _board_id * 128, _hit.clock}; }),
-          fFADCChMapper([](uint32_t _plane_id, uint32_t _board_id, uint32_t _ch) -> uint32_t
-                        { return _ch + _board_id * MAIKo2Decoder::FADCData::NumberOfChannels; }){};
 
-    BuiltEventData(std::function<Hit(uint32_t, uint32_t, Hit)> _fHitMapper,
-                   std::function<uint32_t(uint32_t, uint32_t, uint32_t)> _fFADCChMapper)
-        : fHitMapper(_fHitMapper),
-          fFADCChMapper(_fFADCChMapper){};
-
-    struct AddFragmentResult
+    if (argc < 3)
     {
-        AddFragmentResult()
-            : good(false), fragment_key_duplication(false), map_duplication(false){};
-        bool good;
-        bool fragment_key_duplication;
-        bool map_duplication;
-    };
+        std::cerr << "[Usage] : " << argv[0] << " [run_id] [event_number | first_event_number-last_event_number] [data_directory_path | built_event_file]" << std::endl;
+        return 1;
+    }
 
-    AddFragmentResult AddFragment(const FragmentedEventData &_frg)
-    {
-        AddFragmentResult result;
-        // Check duplication
-        // Duplication of fragment key
-        if (fEventFragments.count({_frg.plane_id, _frg.board_id}) > 0)
-        {
-            result.good = false;
-            result.fragment_key_duplication = true;
-            return result;
-        }
-        for (uint32_t iCh = 0; iCh < MAIKo2Decoder::FADCData::NumberOfChannels; ++iCh)
+    uint32_t run_id = atoi(argv[1]);
+
+    // Identifier of the event
+    //    Same to trigger_counter for now.
+    // The events in a range (e.g. 100-199) are fetched at once and summarized.
+    const std::string eventNumberArg = argv[2];
+    const auto posHyphen = eventNumberArg.find('-');
+    uint32_t event_number = atoi(eventNumberArg.substr(0, posHyphen).c_str());
+    const uint32_t last_event_number = (posHyphen == std::string::npos) ? event_number : atoi(eventNumberArg.substr(posHyphen + 1).c_str());
+    const bool isRange = (last_event_number != event_number);
+
+    std::vector<MAIKo2Decoder::FetchedEvent> vEvents;
+    // All fragments of an event are read at once from the built-event file written by build_events if it is given
+    MAIKo2Decoder::BuiltEventFile builtEventFile(argc >= 4 ? argv[3] : "");
+    if (builtEventFile.IsGood())
+    {
+        if (builtEventFile.GetRunId() != run_id)
         {
-            uint32_t chMapped = fFADCChMapper(_frg.plane_id, _frg.board_id, iCh);
-            // Duplication in inverted map is detected
-            if (fFADCInvertedMap.count({_frg.plane_id, chMapped}) > 0)
-            {
-                result.good = false;
-                result.map_duplication = true;
-                return result;
-            }
+            std::cerr << "[Error] : Built-event file " << argv[3] << " is of run " << builtEventFile.GetRunId() << "." << std::endl;
+            return 1;
         }
-
-        // No duplication detected -> Add
-        for (uint32_t iCh = 0; iCh < MAIKo2Decoder::FADCData::NumberOfChannels; ++iCh)
+        for (uint64_t trigger_counter = event_number; trigger_counter <= last_event_number; ++trigger_counter)
         {
-            uint32_t chMapped = fFADCChMapper(_frg.plane_id, _frg.board_id, iCh);
-            KeyOfFragment keyFragment(_frg.plane_id, _frg.board_id);
-            // Register into inv-Map
-            auto fragment_locator = std::make_pair(keyFragment, iCh);
-            fFADCInvertedMap.insert(std::make_pair(FullyQualifiedChannelForFADC(_frg.plane_id, chMapped), fragment_locator));
-            // Register into Fragments
-            fEventFragments.insert(std::make_pair(keyFragment, _frg));
+            MAIKo2Decoder::FetchedEvent evt;
+            evt.trigger_counter = trigger_counter;
+            if (builtEventFile.ReadEvent(evt.trigger_counter, evt.fragments))
+                vEvents.push_back(std::move(evt));
         }
-        result.good = true;
-        return result;
-    };
-
-    std::vector<Hit> GetHits(uint32_t _plane_id) const
+    }
+    else
     {
-
-        std::vector<Hit> ret;
-        for (auto &frg : fEventFragments)
+        std::vector<MAIKo2Decoder::FragmentLocation> vLocations;
+        if (argc >= 4)
         {
-            if (frg.first.plane_id != _plane_id)
-                continue;
-
-            for (auto hit : frg.second.tpc.GetHits())
+            // Look up the sidecar indexes written by make_index instead of DB.
+            // Files without them (e.g. being written) are bisected on the trigger counter.
+            const std::string dataDirectoryPath = argv[3];
+            const std::string rawDataFileFormat = "uTPC_$[run_id]_$[plane]$[board_id]_$[file_number].raw";
+            const std::map<unsigned int, std::string> planeList = {{0, "anode"},
+                                                                   {1, "cathode"}};
+            const unsigned int nPlane = 2;
+            const unsigned int nBoard = 6;
+            for (unsigned int iPlane = 0; iPlane < nPlane; ++iPlane)
             {
-                ret.emplace_back(fHitMapper(_plane_id, frg.second.board_id, hit));
-
-                // std::cout << "Plane " << _plane_id
-                //           << " board " << frg.second.board_id
-                //           << " hit " << hit.strip << " " << hit.clock << std::endl;
-                // std::cout << "    -> "
-                //           << fHitMapper(_plane_id, frg.second.board_id, hit).strip << " "
-                //           << fHitMapper(_plane_id, frg.second.board_id, hit).clock
-                //           << std::endl;
+                for (unsigned int iBoard = 0; iBoard < nBoard; ++iBoard)
+                {
+                    for (unsigned int file_number = 0;; ++file_number)
+                    {
+                        const std::string filePath = dataDirectoryPath + "/" +
+                                                     MAIKo2Decoder::GenerateFileName(rawDataFileFormat,
+                                                                                     run_id, 4,
+                                                                                     iPlane, planeList,
+                                                                                     iBoard, 1,
+                                                                                     file_number, 5);
+                        if (!std::ifstream(filePath).good())
+                            break;
+
+                        MAIKo2Decoder::FragmentLocation loc;
+                        loc.run_id = run_id;
+                        loc.plane_id = iPlane;
+                        loc.board_id = iBoard;
+                        loc.file_path = filePath;
+                        MAIKo2Decoder::SidecarIndex sidecarIndex(MAIKo2Decoder::GetSidecarIndexPath(filePath));
+                        for (uint64_t trigger_counter = event_number; trigger_counter <= last_event_number; ++trigger_counter)
+                        {
+                            loc.event_trigger_counter = trigger_counter;
+                            if (!sidecarIndex.IsGood())
+                            {
+                                // The word offsets are found when the words are read
+                                auto seek = MAIKo2Decoder::SeekTriggerCounter(filePath, trigger_counter);
+                                if (!seek.goodFlag)
+                                    continue;
+                                loc.event_data_address = seek.event_data_address;
+                                loc.event_data_length = seek.event_data_length;
+                                loc.event_fadc_words_offset = 0;
+                                loc.event_tpc_words_offset = 0;
+                                vLocations.push_back(loc);
+                                continue;
+                            }
+                            auto found = sidecarIndex.FindByTriggerCounter(trigger_counter);
+                            for (auto rec = found.first; rec != found.second; ++rec)
+                            {
+                                loc.event_data_address = rec->event_data_address;
+                                loc.event_data_length = rec->event_data_length;
+                                loc.event_fadc_words_offset = rec->event_fadc_words_offset;
+                                loc.event_tpc_words_offset = rec->event_tpc_words_offset;
+                                vLocations.push_back(loc);
+                            }
+                        }
+                    }
+                }
             }
         }
-        return ret;
-    }
-
-    std::vector<ShortWordType> GetSignal(uint32_t _plane_id, uint32_t _ch) const
-    {
-        auto itMap = fFADCInvertedMap.find({_plane_id, _ch});
-        if (itMap == fFADCInvertedMap.end())
-            return {};
-
-        auto keyOfFragment = itMap->second.first;
-        uint32_t ch = itMap->second.second;
-
-        return fEventFragments.at(keyOfFragment).fadc.GetSignal(ch);
-    }
-
-    std::vector<uint32_t> GetAvailableFADCCh(uint32_t _plane_id) const
-    {
-        std::vector<uint32_t> ret;
-        std::for_each(fFADCInvertedMap.begin(), fFADCInvertedMap.end(),
-                      [&](auto &_item)
-                      {
-                          if (_item.first.plane_id == _plane_id)
-                              ret.push_back(_item.first.ch);
-                      });
-        std::sort(ret.begin(), ret.end(), std::less<uint32_t>());
-        return ret;
-    }
-
-private:
-    // Mapper function for TPC Hit (plane_id, board_id, Hit) -> Hit (mapped)
-    std::function<Hit(uint32_t, uint32_t, Hit)> fHitMapper;
-
-    // Mapper function for FADC Ch (plane_id, board_id, ch) -> ch (mapped)
-    std::function<uint32_t(uint32_t, uint32_t, uint32_t)> fFADCChMapper;
-
-    struct FullyQualifiedChannelForFADC
-    {
-        FullyQualifiedChannelForFADC(uint32_t _plane_id, uint32_t _ch)
-            : plane_id(_plane_id), ch(_ch){};
-        uint32_t plane_id;
-        uint32_t ch;
-        bool operator<(const FullyQualifiedChannelForFADC &_rhs) const
+        else
         {
-            if (plane_id != _rhs.plane_id)
-                return plane_id < _rhs.plane_id;
-            else if (ch != _rhs.ch)
-                return ch < _rhs.ch;
-            else
-                return false;
+            // Connect to db
+            pqxx::connection c("");
+            std::cout << "Connected to " << c.dbname() << '\n';
+
+            pqxx::work tx{c};
+            try
+            {
+                // All fragments of the events in a single query
+                vLocations = MAIKo2Decoder::QueryFragmentLocations(tx, "test.raw_events", "test.raw_files",
+                                                                   run_id, event_number, last_event_number);
+                tx.commit();
+            }
+            catch (const pqxx::sql_error &_e)
+            {
+                std::cerr << "[Error] : SQL exception occurred while selecting event records for "
+                          << "run " << run_id << ", event number " << eventNumberArg << " "
+                          << "from DB." << std::endl;
+                std::cerr << _e.what() << std::endl;
+            }
+            catch (const pqxx::usage_error &_e)
+            {
+                std::cerr << "[Error] : Some libpqxx usage exception occurred while selecting event records for "
+                          << "run " << run_id << ", event number " << eventNumberArg << " "
+                          << "from DB." << std::endl;
+                std::cerr << _e.what() << std::endl;
+            }
+            catch (const std::exception &_e)
+            {
+                std::cerr << "[Error] : Some exception occurred while selecting event records for "
+                          << "run " << run_id << ", event number " << eventNumberArg << " "
+                          << "from DB." << std::endl;
+                std::cerr << _e.what() << std::endl;
+            }
         }
-    };
 
-    struct KeyOfFragment
-    {
-        uint32_t plane_id;
-        uint32_t board_id;
-        KeyOfFragment(uint32_t _plane_id, uint32_t _board_id)
-            : plane_id(_plane_id), board_id(_board_id){};
-        bool operator<(const KeyOfFragment &_rhs) const
+        if (!isRange)
         {
-            if (plane_id != _rhs.plane_id)
-                return plane_id < _rhs.plane_id;
-            else if (board_id != _rhs.board_id)
-                return board_id < _rhs.board_id;
-            else
-                return false;
+            for (auto &loc : vLocations)
+                std::cout << DumpFragmentLocation(loc) << std::endl;
         }
-    };
-
-    // Inverted map for fetching FADC signal efficiently
-    std::map<FullyQualifiedChannelForFADC, std::pair<KeyOfFragment, uint32_t>> fFADCInvertedMap;
-
-    // Fragment store
-    std::map<KeyOfFragment, FragmentedEventData> fEventFragments;
-
-    // uint32_t a;
-};
 
-int main(int argc, char *argv[])
-{
+        // Reads of the fragments are grouped by file, sorted and merged
+        MAIKo2Decoder::BatchedEventReader reader;
+        vEvents = reader.Read(vLocations);
+        const auto &stat = reader.GetStatistics();
+        std::cout << "Read : " << stat.number_of_fragments << " fragments in " << stat.number_of_files << " files "
+                  << "by " << stat.number_of_reads << " reads (" << stat.number_of_bytes_read << " bytes), "
+                  << stat.number_of_failed_fragments << " failed" << std::endl;
+    }
 
-    if (argc < 3)
+    if (vEvents.size() == 0)
     {
-        std::cerr << "[Usage] : " << argv[0] << " [run_id] [event_number]" << std::endl;
+        std::cerr << "[Error] : Run " << run_id << ", event " << eventNumberArg << " is NOT found." << std::endl;
         return 1;
     }
 
-    uint32_t run_id = atoi(argv[1]);
-
-    // Identifier of the event
-    //    Same to trigger_counter for now.
-    uint32_t event_number = atoi(argv[2]);
-
-    // Connect to db
-    pqxx::connection c("");
-    std::cout << "Connected to " << c.dbname() << '\n';
-
-    pqxx::work tx{c};
-    std::vector<EventIndex> vIndexes;
-    try
+    MAIKo2Decoder::WorkStealingPool pool;
+    if (isRange)
     {
-        std::ostringstream query;
-        query << "SELECT "
-              << "e.run_id, e.plane_id, e.board_id, f.file_path, "
-              << "e.event_data_address, e.event_data_length, "
-              << "e.event_fadc_words_offset, e.event_tpc_words_offset "
-              << "FROM test.raw_events AS e "
-              << "INNER JOIN test.raw_files AS f ON "
-              << "e.run_id = f.run_id AND "
-              << "e.plane_id = f.plane_id AND "
-              << "e.board_id = f.board_id AND "
-              << "e.file_number = f.file_number "
-              << "WHERE "
-              << "e.run_id = " << run_id << " AND "
-              << "e.event_trigger_counter = " << event_number << " "
-              << "ORDER BY (e.plane_id, e.board_id)"
-              << ";"
-              << std::endl;
-
-        pqxx::result res(tx.exec(query.str()));
-
-        for (auto row : res)
+        for (auto &evt : vEvents)
         {
-            for (auto i = 0; i < (int)row.size(); ++i)
-            {
-                std::cout << row[i] << " ";
-            }
-            std::cout << std::endl;
-
-            EventIndex ind;
-            ind.run_id = row[0].as<decltype(ind.run_id)>();
-            ind.plane_id = row[1].as<decltype(ind.plane_id)>();
-            ind.board_id = row[2].as<decltype(ind.board_id)>();
-            ind.file_path = row[3].as<decltype(ind.file_path)>();
-            ind.event_data_address = row[4].as<decltype(ind.event_data_address)>();
-            ind.event_data_length = row[5].as<decltype(ind.event_data_length)>();
-            ind.event_fadc_words_offset = row[6].as<decltype(ind.event_fadc_words_offset)>();
-            ind.event_tpc_words_offset = row[7].as<decltype(ind.event_tpc_words_offset)>();
-            vIndexes.push_back(ind);
+            MAIKo2Decoder::BuiltEventData data;
+            bool good = MAIKo2Decoder::BatchedEventReader::BuildEvent(run_id, evt, data, &pool);
+            std::cout << "Event " << evt.trigger_counter << " : "
+                      << evt.fragments.size() << " fragments, "
+                      << data.GetHits(0).size() << " anode hits, "
+                      << data.GetHits(1).size() << " cathode hits"
+                      << (good ? "" : " [Error] : some fragments failed") << std::endl;
         }
-
-        tx.commit();
-    }
-    catch (const pqxx::sql_error &_e)
-    {
-        std::cerr << "[Error] : SQL exception occurred while selecting event records for "
-                  << "run " << run_id << ", event number " << event_number << " "
-                  << "from DB." << std::endl;
-        std::cerr << _e.what() << std::endl;
-    }
-    catch (const pqxx::usage_error &_e)
-    {
-        std::cerr << "[Error] : Some libpqxx usage exception occurred while selecting event records for "
-                  << "run " << run_id << ", event number " << event_number << " "
-                  << "from DB." << std::endl;
-        std::cerr << _e.what() << std::endl;
-    }
-    catch (const std::exception &_e)
-    {
-        std::cerr << "[Error] : Some exception occurred while selecting event records for "
-                  << "run " << run_id << ", event number " << event_number << " "
-                  << "from DB." << std::endl;
-        std::cerr << _e.what() << std::endl;
-    }
-
-    for (auto &ind : vIndexes)
-    {
-        std::cout << ind.Dump() << std::endl;
+        return 0;
     }
 
-    if (vIndexes.size() == 0)
+    if (!vEvents.front().good)
     {
-        std::cerr << "[Error] : Run " << run_id << ", event " << event_number << " is NOT found." << std::endl;
+        std::cerr << "[Error] : Some fragments of run " << run_id << ", event " << event_number << " can NOT be read." << std::endl;
         return 1;
     }
-
-    // Decode
-    std::vector<FragmentedEventData> vFragments;
-    for (auto &ind : vIndexes)
-    {
-        std::ifstream fIn(ind.file_path, std::ios::binary);
-        if (!fIn.good())
-        {
-            std::cerr << "[Error] : File " << ind.file_path << " is NOT found." << std::endl;
-            return 1;
-        }
-        fIn.seekg(ind.event_data_address, std::ios_base::beg);
-        auto wordsEvent = MAIKo2Decoder::ReadNextWords(fIn, ind.event_data_length / sizeof(MAIKo2Decoder::WordType));
-        MAIKo2Decoder::EventWordsBuffer buf(wordsEvent, ind.event_fadc_words_offset, ind.event_tpc_words_offset);
-
-        if (!buf.IsValid())
-        {
-            std::cerr << "[Error] : Word buffer at " << ind.event_data_address << " "
-                      << "in the file " << ind.file_path << " "
-                      << "is in the wrong format." << std::endl;
-            return 1;
-        }
-
-        MAIKo2Decoder::CounterData counter(buf.GetCounterWords());
-        MAIKo2Decoder::FADCData fadc(buf.GetFADCWords());
-        MAIKo2Decoder::TPCData tpc(buf.GetTPCWords());
-
-        FragmentedEventData frg;
-        frg.run_id = ind.run_id;
-        frg.plane_id = ind.plane_id;
-        frg.board_id = ind.board_id;
-        frg.event_number = event_number;
-        frg.counter = counter;
-        frg.fadc = fadc;
-        frg.tpc = tpc;
-
-        vFragments.push_back(frg);
-
-        if (!counter.IsGood() ||
-            !fadc.IsGood() ||
-            !tpc.IsGood())
+    const std::vector<MAIKo2Decoder::StoredFragment> &vStoredFragments = vEvents.front().fragments;
+
+    // Decode the fragments concurrently
+    std::vector<MAIKo2Decoder::FragmentTiming> vTimings;
+    std::vector<MAIKo2Decoder::FragmentedEventData> vFragments =
+        MAIKo2Decoder::DecodeFragments(run_id, event_number, vStoredFragments, &pool, vTimings);
+    for (std::size_t i = 0; i < vFragments.size(); ++i)
+    {
+        const auto &frg = vFragments[i];
+        std::cout << "Decode : plane_id " << frg.plane_id << ", board_id " << frg.board_id << " : "
+                  << vTimings[i].decode_seconds * 1e6 << " us" << std::endl;
+        if (!frg.counter.IsGood() ||
+            !frg.fadc.IsGood() ||
+            !frg.tpc.IsGood())
         {
-            std::cerr << "[Error] : Decode for the event at " << ind.event_data_address << " "
-                      << "in the file " << ind.file_path << " "
+            std::cerr << "[Error] : Decode for the event fragment with the plane_id " << frg.plane_id << " "
+                      << "and the board_id " << frg.board_id << " "
                       << "failed." << std::endl;
 
-            std::cerr << counter.IsGood() << " "
-                      << fadc.IsGood() << " "
-                      << tpc.IsGood() << std::endl;
+            std::cerr << frg.counter.IsGood() << " "
+                      << frg.fadc.IsGood() << " "
+                      << frg.tpc.IsGood() << std::endl;
 
             return 1;
         }
     }
 
-    BuiltEventData data;
+    MAIKo2Decoder::BuiltEventData data;
     for (auto &frg : vFragments)
     {
-        auto result = data.AddFragment(frg);
+        auto result = data.AddFragment(std::move(frg));
         // std::cout << frg.plane_id << " " << frg.board_id << std::endl;
         if (!result.good)
         {
             std::cerr << "[Error] : Build for the event fragment with the plane_id " << frg.plane_id << " "
                       << "and the board_id " << frg.board_id << " "
                       << "failed." << std::endl;
-            std::cerr << result.fragment_key_duplication << " " << result.map_duplication << std::endl;
+            std::cerr << result.fragment_key_duplication << " " << result.map_duplication << " " << result.out_of_topology << std::endl;
         }
     }
 